@@ -18,4 +18,15 @@ extern zend_module_entry psampler_module_entry;
 #include "TSRM.h"
 #endif
 
+// Cache de bancos polyphase compartilhados entre os resamplers da requisição (zerado no RINIT)
+ZEND_BEGIN_MODULE_GLOBALS(psampler)
+    struct _psampler_bank *banks;
+ZEND_END_MODULE_GLOBALS(psampler)
+
+#define PSAMPLER_G(v) ZEND_MODULE_GLOBALS_ACCESSOR(psampler, v)
+
+#if defined(ZTS) && defined(COMPILE_DL_PSAMPLER)
+ZEND_TSRMLS_CACHE_EXTERN()
+#endif
+
 #endif /* PHP_PSAMPLER_H */
@@ -8,16 +8,111 @@
 #include <zend_smart_str.h>
 #include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
 #define FILTER_LENGTH 64
+#define FILTER_HALF (FILTER_LENGTH / 2)
+#define FILTER_PHASES 256
+#define FILTER_SUPPORT 31.0   // janela Kaiser em |d| < 31: permite guardar só metade das fases
 #define KAISER_BETA 8.6
 #define MAX_BUFFER_SIZE 8192
 
+// Filtros half-band (fator 2) e third-band (fator 3) para razões inteiras
+#define HALFBAND_TAPS 63
+#define HALFBAND_NONZERO 16   // taps não nulos por lado do centro
+#define THIRDBAND_TAPS 47
+#define THIRDBAND_NONZERO 16
+#define MAX_CASCADE_STAGES 4
+
+// Presets de qualidade: DEFAULT usa polyphase/cascata, HIGH e OFFLINE usam convolução por FFT
+#define PSAMPLER_QUALITY_DEFAULT 0
+#define PSAMPLER_QUALITY_HIGH 1
+#define PSAMPLER_QUALITY_OFFLINE 2
+
+// Taps do filtro longo, medidos na menor das duas taxas
+#define FFT_TAPS_HIGH 512
+#define FFT_TAPS_OFFLINE 4096
+#define FFT_MAX_TAPS 65535
+#define LONGFIR_MAX_TAPS (1 << 22)
+#define LONG_FILTER_FFT_WEIGHT 16.0
+#define KAISER_BETA_OFFLINE 12.0
+
+ZEND_DECLARE_MODULE_GLOBALS(psampler)
+
 static zend_class_entry *psampler_ce;
 static zend_class_entry *lpcm_ce;
+static zend_class_entry *analyzer_ce;
+
+typedef enum {
+    STAGE_UP2,
+    STAGE_DOWN2,
+    STAGE_UP3,
+    STAGE_DOWN3
+} psampler_stage_kind;
+
+// Estágio da cascata: buffer [histórico | bloco atual] em float, crescido sob demanda.
+// O estágio anterior escreve direto depois do histórico, sem cópia intermediária.
+typedef struct {
+    psampler_stage_kind kind;
+    int history_len;
+    int phase;
+    float *buf;
+    size_t buf_size;
+} psampler_stage;
+
+// Plano de FFT real de N pontos (FFT complexa de N/2 pontos + pós-processamento)
+typedef struct {
+    int size;
+    int half;
+    double *twiddle;   // e^{-2πik/(N/2)}, k < N/2
+    double *rtwiddle;  // e^{-2πik/N}, k < N/2
+    int *bitrev;
+} psampler_fft;
+
+// Convolução overlap-save na taxa interpolada (interpola por L, filtra, decima por M)
+typedef struct {
+    psampler_fft fft;
+    int interp;
+    int decim;
+    int taps;
+    int block;          // amostras novas por bloco: N - taps + 1
+    int fill;
+    int phase;
+    int delay;          // atraso de grupo (taps - 1) / 2, descontado no início do fluxo
+    double *spectrum;   // resposta em frequência do filtro (N/2 + 1 bins complexos)
+    double *frame;      // [taps - 1 de histórico | block novas]
+    double *work;       // espectro do bloco | resultado da convolução | scratch da FFT
+} psampler_ols;
+
+// O mesmo filtro longo aplicado direto por ramos polyphase: cada saída calcula só a
+// fase n mod L, sem inserir zeros nem descartar M - 1 de cada M amostras filtradas
+typedef struct {
+    int interp;
+    int decim;
+    int branch_len;     // coeficientes por fase, múltiplo de 8
+    int delay;          // atraso de grupo na taxa interpolada
+    int phase;          // fase da próxima saída (n mod L)
+    float *rows;        // interp linhas de branch_len, na ordem da entrada (mais antiga primeiro)
+    float *input;       // [branch_len - 1 de histórico | entrada nova]
+    size_t input_size;
+    size_t input_used;
+    size_t next;        // posição em input da amostra mais recente da próxima saída
+} psampler_longfir;
+
+// Banco polyphase em float, compartilhado por todos os contextos com a mesma razão.
+// Só as fases 0..FILTER_PHASES/2 são guardadas; as demais são as mesmas linhas invertidas.
+typedef struct _psampler_bank {
+    double ratio;
+    int refcount;
+    float *rows;
+    struct _psampler_bank *next;
+} psampler_bank;
 
 typedef struct _psampler_context {
     double ratio;
@@ -31,27 +126,88 @@ typedef struct _psampler_context {
     
     double frac_pos;
     
-    double *filter_bank;
-    int filter_length;
-    int phases;
-    
+    psampler_bank *bank;
+
+    // Cascata half-band para fatores inteiros (0 = usa o filtro polyphase)
+    int cascade_stages;
+    psampler_stage *cascade; // alocado só pelos contextos que usam a cascata
+    float *cascade_out;      // saída do último estágio
+    float *cascade_scratch;  // ramos separados dos estágios de decimação
+    size_t cascade_out_size;
+    size_t cascade_scratch_size;
+    size_t cascade_skip;     // saídas iniciais ainda a descartar (atraso de grupo da interpolação)
+
+    // Motor dos presets HIGH/OFFLINE: FFT ou ramos polyphase (NULL = não usado)
+    psampler_ols *ols;
+    psampler_longfir *longfir;
+    uint64_t stream_in;      // entrada recebida desde o início do fluxo (para o flush)
+    uint64_t stream_out;     // saída emitida desde o início do fluxo
+
+    // Caminho rápido de silêncio: |x| <= silence_threshold conta como zero (-1 desliga)
+    int silence_threshold;
+    size_t loud_end;         // polyphase: fim da última amostra audível no input_buffer
+    size_t quiet_run;        // cascata: amostras silenciosas consecutivas na entrada
+    size_t cascade_settle;   // cascata: entrada silenciosa necessária para zerar os históricos
+    zend_long silent_samples;
+
     struct _psampler_context *next;
 } psampler_context;
 
+#define FANOUT_MAX_RATES 8
+
+// Saída de um fan-out: a fase, o filtro de DC e a referência ao banco são próprios de cada taxa
+typedef struct {
+    zend_long dst_rate;
+    double ratio;
+    double frac_pos;
+    double last_dc;     // DC removido na saída, como em sample()
+    psampler_bank *bank;
+} psampler_branch;
+
+// Fan-out: um único histórico de entrada em float alimenta várias taxas de saída
+typedef struct {
+    zend_long src_rate;
+    int branch_count;
+    psampler_branch branches[FANOUT_MAX_RATES];
+    float *input_buffer;
+    size_t buffer_size;
+    size_t buffer_used;
+    int silence_threshold;   // mesmo caminho rápido de silêncio do polyphase
+    size_t loud_end;
+    zend_long silent_samples;
+} psampler_fanout;
+
 typedef struct {
     psampler_context *contexts;
     psampler_context *current_context;
     
     int pending_samples;
     int min_output_samples;
+    int quality;
+    int silence_threshold;
+    
+    // Modo framed: FIFO linear de saída consumida em quadros por pull()
+    int16_t *fifo;
+    size_t fifo_size;
+    size_t fifo_start;
+    size_t fifo_used;
+    size_t frame_size;
+    
+    // Analyzer opcional alimentado com a saída de sample()/push()
+    zend_object *analyzer;
+    
+    // Grupo de fan-out (NULL até o primeiro fanout())
+    psampler_fanout *fanout;
     
     zend_object std;
 } psampler_object;
 
 #define PSAMPLER_OBJ(zv) ((psampler_object *)((char *)(Z_OBJ_P(zv)) - XtOffsetOf(psampler_object, std)))
 
+#define LPCM_MAX_CHANNELS 32
+
 typedef struct {
-    int channels;      // 1 = mono, 2 = stereo
+    int channels;      // 1 = mono, 2 = stereo, até LPCM_MAX_CHANNELS intercalados
     int bit_depth;     // 8, 16, 24, 32
     int is_big_endian; // 0 = little-endian, 1 = big-endian
     zend_object std;
@@ -59,6 +215,39 @@ typedef struct {
 
 #define LPCM_OBJ(zv) ((lpcm_object *)((char *)(Z_OBJ_P(zv)) - XtOffsetOf(lpcm_object, std)))
 
+#define ANALYZER_MAX_EDGES 16
+#define ANALYZER_DEFAULT_CLIP 32000
+
+// Estatísticas acumuladas de PCM 16-bit mono; o espectro é medido em quadros de fft_size
+typedef struct {
+    int sample_rate;
+    int fft_size;
+    int clip_threshold;
+    int edge_count;
+    double edges[ANALYZER_MAX_EDGES];
+    
+    psampler_fft fft;
+    double *window;     // Hann, fft_size
+    double *work;       // quadro | espectro (N + 2) | scratch (N)
+    int *bin_band;      // banda de cada bin, N/2 + 1
+    int fill;
+    
+    zend_long samples;
+    zend_long clipped;
+    zend_long crossings;
+    int64_t sum;
+    uint64_t sum_sq;
+    int peak;
+    int16_t last;
+    zend_long frames;
+    double band_energy[ANALYZER_MAX_EDGES + 1];
+    
+    zend_object std;
+} analyzer_object;
+
+#define ANALYZER_OBJ(zv) ((analyzer_object *)((char *)(Z_OBJ_P(zv)) - XtOffsetOf(analyzer_object, std)))
+#define ANALYZER_FROM_OBJ(o) ((analyzer_object *)((char *)(o) - XtOffsetOf(analyzer_object, std)))
+
 // Função Bessel I0 modificada para janela Kaiser
 static double bessel_i0(double x)
 {
@@ -88,624 +277,3152 @@ static double sinc(double x)
     return sin(M_PI * x) / (M_PI * x);
 }
 
-// Gera banco de filtros polyphase de alta qualidade
-static void generate_filter_bank(psampler_context *ctx)
+// Preenche as fases 0..FILTER_PHASES/2: a linha p vale h(i - FILTER_HALF - p/FILTER_PHASES)
+static void generate_filter_bank(float *rows, double ratio)
 {
-    int filter_len = FILTER_LENGTH;
-    int phases = 256; // Número de fases para interpolação suave
-    
-    ctx->filter_length = filter_len;
-    ctx->phases = phases;
-    ctx->filter_bank = (double *)emalloc(filter_len * phases * sizeof(double));
-    
-    double cutoff = (ctx->ratio < 1.0) ? ctx->ratio : 1.0;
+    // Corte na menor das duas Nyquists, em ciclos por amostra de entrada
+    double cutoff = 0.5 * ((ratio < 1.0) ? ratio : 1.0);
     cutoff *= 0.95; // Margem de segurança para anti-aliasing
     
-    // Gera filtro sinc com janela Kaiser para cada fase
-    for (int phase = 0; phase < phases; phase++) {
-        double phase_offset = (double)phase / phases;
+    for (int phase = 0; phase <= FILTER_PHASES / 2; phase++) {
+        double taps[FILTER_LENGTH];
         double sum = 0.0;
         
-        for (int i = 0; i < filter_len; i++) {
-            double t = i - (filter_len - 1) / 2.0 + phase_offset;
-            double h = sinc(2.0 * cutoff * t) * 2.0 * cutoff;
-            h *= kaiser_window(i, filter_len, KAISER_BETA);
-            ctx->filter_bank[phase * filter_len + i] = h;
+        for (int i = 0; i < FILTER_LENGTH; i++) {
+            double d = i - FILTER_HALF - (double)phase / FILTER_PHASES;
+            double h = 0.0;
+            
+            if (fabs(d) < FILTER_SUPPORT) {
+                double r = d / FILTER_SUPPORT;
+                h = sinc(2.0 * cutoff * d) * bessel_i0(KAISER_BETA * sqrt(1.0 - r * r)) / bessel_i0(KAISER_BETA);
+            }
+            taps[i] = h;
             sum += h;
         }
         
         // Normaliza para manter ganho unitário
-        if (sum > 0.0) {
-            for (int i = 0; i < filter_len; i++) {
-                ctx->filter_bank[phase * filter_len + i] /= sum;
-            }
+        for (int i = 0; i < FILTER_LENGTH; i++) {
+            rows[phase * FILTER_LENGTH + i] = (float)(sum > 0.0 ? taps[i] / sum : taps[i]);
         }
     }
 }
 
-static psampler_context *create_context(double src_rate, double dst_rate)
+// Busca o banco da razão no cache da requisição ou gera um novo
+static psampler_bank *bank_acquire(double ratio)
 {
-    psampler_context *ctx = (psampler_context *)emalloc(sizeof(psampler_context));
-    ctx->src_rate = src_rate;
-    ctx->dst_rate = dst_rate;
-    ctx->ratio = dst_rate / src_rate;
-    ctx->last_dc = 0.0;
-    ctx->frac_pos = 0.0;
+    psampler_bank *bank;
     
-    ctx->buffer_size = MAX_BUFFER_SIZE;
-    ctx->buffer_used = 0;
-    ctx->input_buffer = (int16_t *)emalloc(ctx->buffer_size * sizeof(int16_t));
-    memset(ctx->input_buffer, 0, ctx->buffer_size * sizeof(int16_t));
-    
-    ctx->filter_bank = NULL;
-    ctx->next = NULL;
+    for (bank = PSAMPLER_G(banks); bank; bank = bank->next) {
+        if (bank->ratio == ratio) {
+            bank->refcount++;
+            return bank;
+        }
+    }
     
-    generate_filter_bank(ctx);
+    bank = (psampler_bank *)emalloc(sizeof(psampler_bank));
+    bank->ratio = ratio;
+    bank->refcount = 1;
+    bank->rows = (float *)safe_emalloc(FILTER_PHASES / 2 + 1, FILTER_LENGTH * sizeof(float), 0);
+    generate_filter_bank(bank->rows, ratio);
     
-    return ctx;
+    bank->next = PSAMPLER_G(banks);
+    PSAMPLER_G(banks) = bank;
+    return bank;
 }
 
-static void free_context(psampler_context *ctx)
+static void bank_release(psampler_bank *bank)
 {
-    if (ctx->input_buffer) {
-        efree(ctx->input_buffer);
-    }
-    if (ctx->filter_bank) {
-        efree(ctx->filter_bank);
+    if (--bank->refcount > 0) {
+        return;
     }
-    efree(ctx);
-}
-
-// Destrutor para liberar memória
-static void psampler_free(zend_object *object)
-{
-    psampler_object *obj = (psampler_object *)((char *)object - XtOffsetOf(psampler_object, std));
     
-    psampler_context *ctx = obj->contexts;
-    while (ctx) {
-        psampler_context *next = ctx->next;
-        free_context(ctx);
-        ctx = next;
+    psampler_bank **link = &PSAMPLER_G(banks);
+    while (*link != bank) {
+        link = &(*link)->next;
     }
+    *link = bank->next;
     
-    zend_object_std_dtor(&obj->std);
+    efree(bank->rows);
+    efree(bank);
 }
 
-static zend_object_handlers psampler_handlers;
+// ============================================================================
+// Cascata half-band para razões inteiras (2x, 3x, 4x, 6x, ...)
+// ============================================================================
 
-static zend_object *psampler_create(zend_class_entry *ce)
+// Coeficientes compartilhados por todos os contextos (gerados no MINIT)
+static float halfband_fir[HALFBAND_NONZERO];      // h[c - 31], h[c - 29], ..., h[c - 1]
+static float thirdband_fir[THIRDBAND_NONZERO];    // h[c - 23], h[c - 20], ..., h[c + 22]
+static float thirdband_fir_rev[THIRDBAND_NONZERO]; // h[c - 22], h[c - 19], ..., h[c + 23]
+
+static void generate_integer_filters(void)
 {
-    psampler_object *obj = zend_object_alloc(sizeof(psampler_object), ce);
-    zend_object_std_init(&obj->std, ce);
-    object_properties_init(&obj->std, ce);
-    obj->std.handlers = &psampler_handlers;
-    
-    // Inicializa ponteiros
-    obj->contexts = NULL;
-    obj->current_context = NULL;
-    
-    return &obj->std;
+    double side[(THIRDBAND_TAPS - 1) / 2 + 1];
+    double half[HALFBAND_NONZERO];
+    int center = (HALFBAND_TAPS - 1) / 2;
+    double sum = 0.0;
+
+    // Half-band: taps pares (exceto o centro) são nulos; o centro fica em 0.5
+    for (int i = 0; i < HALFBAND_NONZERO; i++) {
+        int k = center - 2 * i;
+        double h = 0.5 * sinc(k / 2.0) * kaiser_window(center + k, HALFBAND_TAPS, KAISER_BETA);
+        half[i] = h;
+        sum += 2.0 * h;
+    }
+    for (int i = 0; i < HALFBAND_NONZERO; i++) {
+        halfband_fir[i] = (float)(half[i] * 0.5 / sum);
+    }
+
+    // Third-band: taps múltiplos de 3 (exceto o centro) são nulos; o centro fica em 1/3
+    center = (THIRDBAND_TAPS - 1) / 2;
+    sum = 0.0;
+    side[0] = 1.0 / 3.0;
+    for (int k = 1; k <= center; k++) {
+        if (k % 3 == 0) {
+            side[k] = 0.0;
+            continue;
+        }
+        side[k] = sinc(k / 3.0) / 3.0 * kaiser_window(center + k, THIRDBAND_TAPS, KAISER_BETA);
+        sum += 2.0 * side[k];
+    }
+    // Os taps não nulos formam dois ramos de 16; por simetria um é o outro invertido
+    for (int i = 0; i < THIRDBAND_NONZERO; i++) {
+        thirdband_fir[i] = (float)(side[abs(3 * i - center)] * (2.0 / 3.0) / sum);
+        thirdband_fir_rev[THIRDBAND_NONZERO - 1 - i] = thirdband_fir[i];
+    }
 }
 
-// Handlers para LPCM
-static void lpcm_free(zend_object *object)
+static inline int stage_factor(psampler_stage_kind kind)
 {
-    lpcm_object *obj = (lpcm_object *)((char *)object - XtOffsetOf(lpcm_object, std));
-    zend_object_std_dtor(&obj->std);
+    return (kind == STAGE_UP2 || kind == STAGE_DOWN2) ? 2 : 3;
 }
 
-static zend_object_handlers lpcm_handlers;
+static inline int stage_is_up(psampler_stage_kind kind)
+{
+    return kind == STAGE_UP2 || kind == STAGE_UP3;
+}
 
-static zend_object *lpcm_create(zend_class_entry *ce)
+// Σ c[i] * x[i], len múltiplo de 8
+static inline float fir_dot(const float *c, const float *x, int len)
 {
-    lpcm_object *obj = zend_object_alloc(sizeof(lpcm_object), ce);
-    zend_object_std_init(&obj->std, ce);
-    object_properties_init(&obj->std, ce);
-    obj->std.handlers = &lpcm_handlers;
-    
-    // Valores padrão
-    obj->channels = 1;
-    obj->bit_depth = 16;
-    obj->is_big_endian = 0;
+#ifdef __SSE2__
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (int i = 0; i < len; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(c + i), _mm_loadu_ps(x + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(c + i + 4), _mm_loadu_ps(x + i + 4)));
+    }
     
-    return &obj->std;
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < len; i += 4) {
+        for (int u = 0; u < 4; u++) {
+            acc[u] += c[i + u] * x[i + u];
+        }
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
 }
 
-PHP_METHOD(Resampler, __construct)
+// Σ c[i] * (x[i] + x[2 * len - 1 - i]): filtro simétrico de 2 * len taps com len multiplicações
+static inline float fir_dot_symmetric(const float *c, const float *x, int len)
 {
-    zend_long src = 0, dst = 0;
-    ZEND_PARSE_PARAMETERS_START(0, 2)
-        Z_PARAM_OPTIONAL
-        Z_PARAM_LONG(src)
-        Z_PARAM_LONG(dst)
-    ZEND_PARSE_PARAMETERS_END();
-
-    psampler_object *obj = PSAMPLER_OBJ(getThis());
-    obj->pending_samples = 0;
-    obj->min_output_samples = 512; // Mínimo de amostras para pacote válido
+    const float *tail = x + 2 * len - 4;
+#ifdef __SSE2__
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (int i = 0; i < len; i += 8) {
+        __m128 r0 = _mm_loadu_ps(tail - i);
+        __m128 r1 = _mm_loadu_ps(tail - i - 4);
+        __m128 s0 = _mm_add_ps(_mm_loadu_ps(x + i), _mm_shuffle_ps(r0, r0, 0x1B));
+        __m128 s1 = _mm_add_ps(_mm_loadu_ps(x + i + 4), _mm_shuffle_ps(r1, r1, 0x1B));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(c + i), s0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(c + i + 4), s1));
+    }
     
-    // Se as taxas forem fornecidas, cria o primeiro contexto
-    if (src > 0 && dst > 0) {
-        psampler_context *ctx = create_context((double)src, (double)dst);
-        obj->contexts = ctx;
-        obj->current_context = ctx;
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < len; i += 4) {
+        for (int u = 0; u < 4; u++) {
+            acc[u] += c[i + u] * (x[i + u] + tail[3 - i - u]);
+        }
     }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
 }
 
-PHP_METHOD(Resampler, reset)
+// Decimação 2x: y[t] = centro[t] / 2 + Σ h[i] * (x[t + i] + x[t + 31 - i]).
+// Calcula oito saídas por vez nas lanes, sem a soma horizontal do produto escalar;
+// quatro acumuladores independentes escondem a latência das somas.
+static void down2_kernel(const float *x, const float *centers, float *out, size_t count)
 {
-    psampler_object *obj = PSAMPLER_OBJ(getThis());
-    
-    // O usuário solicitou que reset() limpe os contextos/estados
-    psampler_context *ctx = obj->contexts;
-    while (ctx) {
-        psampler_context *next = ctx->next;
-        free_context(ctx);
-        ctx = next;
+    size_t t = 0;
+#ifdef __SSE2__
+    for (; t + 8 <= count; t += 8) {
+        const float *lo = x + t;
+        const float *hi = x + t + 2 * HALFBAND_NONZERO - 1;
+        __m128 acc0 = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_loadu_ps(centers + t));
+        __m128 acc1 = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_loadu_ps(centers + t + 4));
+        __m128 acc2 = _mm_setzero_ps();
+        __m128 acc3 = _mm_setzero_ps();
+        for (int i = 0; i < HALFBAND_NONZERO; i += 2) {
+            __m128 c0 = _mm_set1_ps(halfband_fir[i]);
+            __m128 c1 = _mm_set1_ps(halfband_fir[i + 1]);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(c0, _mm_add_ps(_mm_loadu_ps(lo + i), _mm_loadu_ps(hi - i))));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(c0, _mm_add_ps(_mm_loadu_ps(lo + i + 4), _mm_loadu_ps(hi - i + 4))));
+            acc2 = _mm_add_ps(acc2, _mm_mul_ps(c1, _mm_add_ps(_mm_loadu_ps(lo + i + 1), _mm_loadu_ps(hi - i - 1))));
+            acc3 = _mm_add_ps(acc3, _mm_mul_ps(c1, _mm_add_ps(_mm_loadu_ps(lo + i + 5), _mm_loadu_ps(hi - i + 3))));
+        }
+        _mm_storeu_ps(out + t, _mm_add_ps(acc0, acc2));
+        _mm_storeu_ps(out + t + 4, _mm_add_ps(acc1, acc3));
+    }
+#endif
+    // Mesma ordem de soma das lanes: a saída não depende do tamanho do bloco
+    for (; t < count; t++) {
+        const float *lo = x + t;
+        const float *hi = x + t + 2 * HALFBAND_NONZERO - 1;
+        float even = 0.5f * centers[t], odd = 0.0f;
+        for (int i = 0; i < HALFBAND_NONZERO; i += 2) {
+            even += halfband_fir[i] * (lo[i] + hi[-i]);
+            odd += halfband_fir[i + 1] * (lo[i + 1] + hi[-i - 1]);
+        }
+        out[t] = even + odd;
     }
-    
-    obj->contexts = NULL;
-    obj->current_context = NULL;
-    obj->pending_samples = 0;
-    
-    RETURN_TRUE;
 }
 
-PHP_METHOD(Resampler, returnEmpty)
+// Decimação 3x: y[t] = centro[t] / 3 + Σ h0[i] * ramo0[t + i] + h1[i] * ramo1[t + i], oito saídas por vez
+static void down3_kernel(const float *branch0, const float *branch1, const float *centers, float *out, size_t count)
 {
-    psampler_object *obj = PSAMPLER_OBJ(getThis());
-    
-    // Verifica se há amostras pendentes suficientes para um pacote válido
-    if (obj->pending_samples >= obj->min_output_samples) {
-        obj->pending_samples = 0;
-        RETURN_FALSE; // Retorna false indicando que há pacote válido disponível
+    size_t t = 0;
+#ifdef __SSE2__
+    for (; t + 8 <= count; t += 8) {
+        const float *b0 = branch0 + t;
+        const float *b1 = branch1 + t;
+        __m128 acc0 = _mm_mul_ps(_mm_set1_ps(1.0f / 3.0f), _mm_loadu_ps(centers + t));
+        __m128 acc1 = _mm_mul_ps(_mm_set1_ps(1.0f / 3.0f), _mm_loadu_ps(centers + t + 4));
+        __m128 acc2 = _mm_setzero_ps();
+        __m128 acc3 = _mm_setzero_ps();
+        for (int i = 0; i < THIRDBAND_NONZERO; i++) {
+            __m128 c0 = _mm_set1_ps(thirdband_fir[i]);
+            __m128 c1 = _mm_set1_ps(thirdband_fir_rev[i]);
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(c0, _mm_loadu_ps(b0 + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(c0, _mm_loadu_ps(b0 + i + 4)));
+            acc2 = _mm_add_ps(acc2, _mm_mul_ps(c1, _mm_loadu_ps(b1 + i)));
+            acc3 = _mm_add_ps(acc3, _mm_mul_ps(c1, _mm_loadu_ps(b1 + i + 4)));
+        }
+        _mm_storeu_ps(out + t, _mm_add_ps(acc0, acc2));
+        _mm_storeu_ps(out + t + 4, _mm_add_ps(acc1, acc3));
+    }
+#endif
+    for (; t < count; t++) {
+        float acc0 = (1.0f / 3.0f) * centers[t], acc1 = 0.0f;
+        for (int i = 0; i < THIRDBAND_NONZERO; i++) {
+            acc0 += thirdband_fir[i] * branch0[t + i];
+            acc1 += thirdband_fir_rev[i] * branch1[t + i];
+        }
+        out[t] = acc0 + acc1;
     }
-    
-    // Retorna string vazia (pacote vazio) enquanto não há amostras suficientes
-    RETURN_EMPTY_STRING();
 }
 
-PHP_METHOD(Resampler, sample)
+// Executa um estágio sobre st->buf = [histórico | n amostras novas] e devolve quantas gerou.
+// scratch precisa comportar history_len + n + 2 * HALFBAND_NONZERO amostras.
+static size_t stage_run(psampler_stage *st, size_t n, float *out, float *scratch)
 {
-    zend_string *input;
-    zend_long src = 0, dst = 0;
-    
-    ZEND_PARSE_PARAMETERS_START(1, 3)
-        Z_PARAM_STR(input)
-        Z_PARAM_OPTIONAL
-        Z_PARAM_LONG(src)
-        Z_PARAM_LONG(dst)
-    ZEND_PARSE_PARAMETERS_END();
+    size_t hist = (size_t)st->history_len;
+    size_t total = hist + n;
+    size_t produced = 0;
+    const float *work = st->buf;
+    size_t e;
 
-    psampler_object *obj = PSAMPLER_OBJ(getThis());
-    psampler_context *ctx = obj->current_context;
-    
-    // Se novas taxas forem fornecidas, busca ou cria o contexto correspondente
-    if (src > 0 && dst > 0) {
-        // Se as taxas fornecidas são as do contexto atual, não faz nada
-        if (ctx && (zend_long)ctx->src_rate == src && (zend_long)ctx->dst_rate == dst) {
-            // Já estamos no contexto correto
-        } else {
-            // Procura na lista de contextos
-            psampler_context *curr = obj->contexts;
-            psampler_context *prev = NULL;
-            while (curr) {
-                if ((zend_long)curr->src_rate == src && (zend_long)curr->dst_rate == dst) {
-                    break;
+    switch (st->kind) {
+        case STAGE_UP2:
+            // Fase par usa os 32 taps ímpares (16 pares simétricos); fase ímpar é só o atraso
+            for (e = hist; e < total; e++) {
+                const float *x = work + e - (HALFBAND_TAPS - 1) / 2;
+                out[produced++] = 2.0f * fir_dot_symmetric(halfband_fir, x, HALFBAND_NONZERO);
+                out[produced++] = x[HALFBAND_NONZERO];
+            }
+            break;
+
+        case STAGE_UP3:
+            // As fases 0 e 1 são espelhadas; a fase 2 é só o atraso
+            for (e = hist; e < total; e++) {
+                const float *x = work + e - (THIRDBAND_NONZERO - 1);
+                out[produced++] = 3.0f * fir_dot(thirdband_fir_rev, x, THIRDBAND_NONZERO);
+                out[produced++] = 3.0f * fir_dot(thirdband_fir, x, THIRDBAND_NONZERO);
+                out[produced++] = x[THIRDBAND_NONZERO - 8];
+            }
+            break;
+
+        case STAGE_DOWN2: {
+            // Os taps não nulos caem todos na paridade oposta ao centro: separa as duas
+            // paridades em vetores contíguos (a outra paridade traz os centros)
+            size_t first = hist + st->phase;
+            size_t count = (first < total) ? (total - first + 1) / 2 : 0;
+            const float *src = work + first - (HALFBAND_TAPS - 1);
+            float *taps = scratch;
+            float *centers = taps + count + 2 * HALFBAND_NONZERO;
+
+            if (count > 0) {
+                for (size_t i = 0; i < count + 2 * HALFBAND_NONZERO - 1; i++) {
+                    taps[i] = src[2 * i];
+                }
+                for (size_t i = 0; i < count; i++) {
+                    centers[i] = src[2 * i + (HALFBAND_TAPS - 1) / 2];
                 }
-                prev = curr;
-                curr = curr->next;
             }
-            
-            if (curr) {
-                // Contexto encontrado
-                obj->current_context = curr;
-                ctx = curr;
-            } else {
-                // Cria novo contexto e adiciona à lista
-                ctx = create_context((double)src, (double)dst);
-                if (prev) {
-                    prev->next = ctx;
-                } else {
-                    obj->contexts = ctx;
+            down2_kernel(taps, centers, out, count);
+            produced = count;
+            st->phase = (int)(first + 2 * count - total);
+            break;
+        }
+
+        case STAGE_DOWN3: {
+            // Mesma ideia com dois ramos: distâncias 3i - 23 e 3i - 22 do centro
+            size_t first = hist + st->phase;
+            size_t count = (first < total) ? (total - first + 2) / 3 : 0;
+            float *branch0 = scratch;
+            float *branch1 = branch0 + count + THIRDBAND_NONZERO;
+            float *centers = branch1 + count + THIRDBAND_NONZERO;
+            const float *src = work + first - (THIRDBAND_TAPS - 1);
+
+            if (count > 0) {
+                for (size_t i = 0; i < count + THIRDBAND_NONZERO - 1; i++) {
+                    branch0[i] = src[3 * i];
+                    branch1[i] = src[3 * i + 1];
+                }
+                for (size_t i = 0; i < count; i++) {
+                    centers[i] = src[3 * i + (THIRDBAND_TAPS - 1) / 2];
                 }
-                obj->current_context = ctx;
             }
+            down3_kernel(branch0, branch1, centers, out, count);
+            produced = count;
+            st->phase = (int)(first + 3 * count - total);
+            break;
         }
     }
-    
-    // Verifica se temos um contexto válido
-    if (!ctx) {
-        php_error_docref(NULL, E_WARNING, "Resampler not initialized with valid sample rates.");
-        RETURN_EMPTY_STRING();
+
+    memmove(st->buf, st->buf + n, hist * sizeof(float));
+    return produced;
+}
+
+// Atraso de grupo de um estágio: (taps - 1) / 2 amostras na taxa mais alta do estágio
+static inline int stage_delay(psampler_stage_kind kind)
+{
+    return (kind == STAGE_UP2 || kind == STAGE_DOWN2) ? (HALFBAND_TAPS - 1) / 2 : (THIRDBAND_TAPS - 1) / 2;
+}
+
+static void add_stage(psampler_context *ctx, psampler_stage_kind kind)
+{
+    psampler_stage *st = &ctx->cascade[ctx->cascade_stages++];
+
+    st->kind = kind;
+    // Decimação: a primeira saída fica no centro do filtro sobre a amostra 0 (sem atraso)
+    st->phase = stage_is_up(kind) ? 0 : stage_delay(kind);
+    switch (kind) {
+        case STAGE_UP2:   st->history_len = 2 * HALFBAND_NONZERO - 1; break;
+        case STAGE_UP3:   st->history_len = THIRDBAND_NONZERO - 1; break;
+        case STAGE_DOWN2: st->history_len = HALFBAND_TAPS - 1; break;
+        case STAGE_DOWN3: st->history_len = THIRDBAND_TAPS - 1; break;
     }
+    st->buf = NULL;
+    st->buf_size = 0;
+}
 
-    const int16_t *new_samples = (const int16_t *)ZSTR_VAL(input);
-    size_t new_count = ZSTR_LEN(input) / 2;
-    
-    if (new_count == 0) {
-        RETURN_EMPTY_STRING();
+// Decompõe a razão em fatores 2 e 3; retorna 0 se não houver cascata aplicável
+static int plan_cascade(psampler_context *ctx, zend_long src, zend_long dst)
+{
+    int up = dst > src;
+    zend_long hi = up ? dst : src;
+    zend_long lo = up ? src : dst;
+    int twos = 0, threes = 0;
+
+    ctx->cascade_stages = 0;
+    if (lo <= 0 || hi == lo || hi % lo != 0) {
+        return 0;
     }
-    
-    // Adiciona novas amostras ao buffer interno do contexto
-    size_t space_available = ctx->buffer_size - ctx->buffer_used;
-    size_t to_copy = (new_count < space_available) ? new_count : space_available;
-    
-    if (to_copy > 0) {
-        memcpy(ctx->input_buffer + ctx->buffer_used, new_samples, to_copy * sizeof(int16_t));
-        ctx->buffer_used += to_copy;
+
+    zend_long factor = hi / lo;
+    while (factor % 2 == 0) { factor /= 2; twos++; }
+    while (factor % 3 == 0) { factor /= 3; threes++; }
+    if (factor != 1 || twos + threes > MAX_CASCADE_STAGES) {
+        return 0;
     }
-    
-    // Calcula quantas amostras de saída podemos gerar
-    int filter_half = ctx->filter_length / 2;
-    double step = 1.0 / ctx->ratio;
-    size_t max_out_samples = 0;
-    
-    if (ctx->buffer_used > filter_half) {
-        max_out_samples = (size_t)((ctx->buffer_used - filter_half) * ctx->ratio);
+    // Na decimação cada estágio filtra na taxa de entrada: de 4x em diante o polyphase
+    // genérico (um produto de 64 taps por saída) já sai mais barato
+    if (!up && twos + threes > 1) {
+        return 0;
     }
-    
-    if (max_out_samples == 0) {
-        RETURN_EMPTY_STRING();
+
+    // Interpolação começa pelos half-band (taxa mais baixa); decimação tem um só estágio
+    ctx->cascade = (psampler_stage *)safe_emalloc(twos + threes, sizeof(psampler_stage), 0);
+    if (up) {
+        for (int i = 0; i < twos; i++) add_stage(ctx, STAGE_UP2);
+        for (int i = 0; i < threes; i++) add_stage(ctx, STAGE_UP3);
+    } else {
+        add_stage(ctx, twos ? STAGE_DOWN2 : STAGE_DOWN3);
     }
-    
-    smart_str out = {0};
-    smart_str_alloc(&out, max_out_samples * 2 + 16, 0);
-    
-    size_t out_count = 0;
-    
-    // Processa com filtro polyphase de alta qualidade
-    while (out_count < max_out_samples) {
-        size_t base_idx = (size_t)ctx->frac_pos;
-        
-        // Verifica se temos amostras suficientes no buffer
-        if (base_idx + filter_half >= ctx->buffer_used) {
-            break;
-        }
-        
-        // Calcula índice da fase do filtro
-        double frac = ctx->frac_pos - base_idx;
-        int phase_idx = (int)(frac * ctx->phases);
-        if (phase_idx >= ctx->phases) phase_idx = ctx->phases - 1;
-        
-        // Aplica filtro polyphase
-        double sample = 0.0;
-        double *filter = &ctx->filter_bank[phase_idx * ctx->filter_length];
-        
-        for (int i = 0; i < ctx->filter_length; i++) {
-            int src_idx = (int)base_idx - filter_half + i;
-            if (src_idx >= 0 && src_idx < (int)ctx->buffer_used) {
-                sample += ctx->input_buffer[src_idx] * filter[i];
-            }
+
+    // Quantas amostras de entrada cabem nos históricos de todos os estágios
+    double scale = 1.0;
+    ctx->cascade_settle = 0;
+    for (int s = 0; s < ctx->cascade_stages; s++) {
+        int factor = stage_factor(ctx->cascade[s].kind);
+        ctx->cascade_settle += (size_t)ceil(ctx->cascade[s].history_len * scale);
+        scale = up ? scale / factor : scale * factor;
+    }
+    ctx->quiet_run = ctx->cascade_settle; // históricos começam zerados
+
+    // Interpolação: descarta o atraso acumulado dos estágios, alinhando a saída ao polyphase
+    ctx->cascade_skip = 0;
+    if (up) {
+        for (int s = 0; s < ctx->cascade_stages; s++) {
+            ctx->cascade_skip = ctx->cascade_skip * stage_factor(ctx->cascade[s].kind) + stage_delay(ctx->cascade[s].kind);
         }
-        
-        // Remoção de DC offset aprimorada (filtro passa-alta de 1 polo)
-        ctx->last_dc = 0.9995 * ctx->last_dc + 0.0005 * sample;
-        sample -= ctx->last_dc;
-        
-        // Clipping suave (soft clipping) para evitar distorção
-        if (sample > 32767.0) sample = 32767.0;
-        else if (sample < -32768.0) sample = -32768.0;
-        
-        int16_t out_sample = (int16_t)lrint(sample);
-        smart_str_appendl(&out, (char *)&out_sample, 2);
-        
-        ctx->frac_pos += step;
-        out_count++;
     }
-    
-    // Atualiza pending_samples para controle de returnEmpty()
+    return ctx->cascade_stages;
+}
+
+// ============================================================================
+// FFT real radix-2/4 e motor overlap-save para filtros longos
+// ============================================================================
+
+static void fft_init(psampler_fft *fft, int size)
+{
+    int half = size / 2;
+    int bits = 0;
+
+    while ((1 << bits) < half) bits++;
+
+    fft->size = size;
+    fft->half = half;
+    fft->twiddle = (double *)safe_emalloc(half, 2 * sizeof(double), 0);
+    fft->rtwiddle = (double *)safe_emalloc(half, 2 * sizeof(double), 0);
+    fft->bitrev = (int *)safe_emalloc(half, sizeof(int), 0);
+
+    for (int k = 0; k < half; k++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            r |= ((k >> b) & 1) << (bits - 1 - b);
+        }
+        fft->bitrev[k] = r;
+        fft->twiddle[2 * k] = cos(2.0 * M_PI * k / half);
+        fft->twiddle[2 * k + 1] = -sin(2.0 * M_PI * k / half);
+        fft->rtwiddle[2 * k] = cos(2.0 * M_PI * k / size);
+        fft->rtwiddle[2 * k + 1] = -sin(2.0 * M_PI * k / size);
+    }
+}
+
+static void fft_free(psampler_fft *fft)
+{
+    efree(fft->twiddle);
+    efree(fft->rtwiddle);
+    efree(fft->bitrev);
+}
+
+// FFT complexa in-place (dados intercalados re/im) já em ordem bit-reversa.
+// Um estágio radix-2 quando log2(n) é ímpar, o resto em radix-4.
+static void fft_complex(const psampler_fft *fft, double *z)
+{
+    int n = fft->half;
+    int len = 1;
+
+    while (len * 4 <= n) len *= 4;
+    if (len != n) {
+        for (int i = 0; i < n; i += 2) {
+            double re = z[2 * i + 2], im = z[2 * i + 3];
+            z[2 * i + 2] = z[2 * i] - re;
+            z[2 * i + 3] = z[2 * i + 1] - im;
+            z[2 * i] += re;
+            z[2 * i + 1] += im;
+        }
+        len = 8;
+    } else {
+        len = 4;
+    }
+
+    for (; len <= n; len *= 4) {
+        int q = len / 4;
+        int stride = n / len;
+
+        for (int base = 0; base < n; base += len) {
+            for (int k = 0; k < q; k++) {
+                // k * stride < n / 4, então 3k * stride nunca passa do fim da tabela
+                const double *w1 = &fft->twiddle[2 * (k * stride)];
+                const double *w2 = &fft->twiddle[2 * (2 * k * stride)];
+                const double *w3 = &fft->twiddle[2 * (3 * k * stride)];
+                double *pa = &z[2 * (base + k)];
+                double *pb = &z[2 * (base + k + q)];
+                double *pc = &z[2 * (base + k + 2 * q)];
+                double *pd = &z[2 * (base + k + 3 * q)];
+
+                // Ordem bit-reversa: [x(4m) | x(4m+2) | x(4m+1) | x(4m+3)]
+                double are = pa[0], aim = pa[1];
+                double bre = pb[0] * w2[0] - pb[1] * w2[1], bim = pb[0] * w2[1] + pb[1] * w2[0];
+                double cre = pc[0] * w1[0] - pc[1] * w1[1], cim = pc[0] * w1[1] + pc[1] * w1[0];
+                double dre = pd[0] * w3[0] - pd[1] * w3[1], dim = pd[0] * w3[1] + pd[1] * w3[0];
+
+                double s0re = are + bre, s0im = aim + bim;
+                double s1re = are - bre, s1im = aim - bim;
+                double s2re = cre + dre, s2im = cim + dim;
+                double s3re = cre - dre, s3im = cim - dim;
+
+                pa[0] = s0re + s2re;  pa[1] = s0im + s2im;
+                pc[0] = s0re - s2re;  pc[1] = s0im - s2im;
+                pb[0] = s1re + s3im;  pb[1] = s1im - s3re;   // (a - b) - i(c - d)
+                pd[0] = s1re - s3im;  pd[1] = s1im + s3re;   // (a - b) + i(c - d)
+            }
+        }
+    }
+}
+
+// Espectro de N reais em N/2 + 1 bins complexos; scratch precisa de N doubles
+static void fft_forward_real(const psampler_fft *fft, const double *in, double *spec, double *scratch)
+{
+    int n = fft->half;
+
+    for (int k = 0; k < n; k++) {
+        int r = fft->bitrev[k];
+        scratch[2 * r] = in[2 * k];
+        scratch[2 * r + 1] = in[2 * k + 1];
+    }
+    fft_complex(fft, scratch);
+
+    spec[0] = scratch[0] + scratch[1];
+    spec[1] = 0.0;
+    spec[2 * n] = scratch[0] - scratch[1];
+    spec[2 * n + 1] = 0.0;
+    for (int k = 1; k < n; k++) {
+        double zre = scratch[2 * k], zim = scratch[2 * k + 1];
+        double cre = scratch[2 * (n - k)], cim = -scratch[2 * (n - k) + 1];
+        double ere = 0.5 * (zre + cre), eim = 0.5 * (zim + cim);
+        double ore = 0.5 * (zim - cim), oim = -0.5 * (zre - cre);
+        double wre = fft->rtwiddle[2 * k], wim = fft->rtwiddle[2 * k + 1];
+        spec[2 * k] = ere + ore * wre - oim * wim;
+        spec[2 * k + 1] = eim + ore * wim + oim * wre;
+    }
+}
+
+// Inversa de fft_forward_real (inclui o fator 1/N); scratch precisa de N doubles
+static void fft_inverse_real(const psampler_fft *fft, const double *spec, double *out, double *scratch)
+{
+    int n = fft->half;
+    double scale = 1.0 / fft->size;
+
+    for (int k = 0; k < n; k++) {
+        double xre = spec[2 * k], xim = spec[2 * k + 1];
+        double cre = spec[2 * (n - k)], cim = -spec[2 * (n - k) + 1];
+        double ere = xre + cre, eim = xim + cim;
+        double dre = xre - cre, dim = xim - cim;
+        // Conjugado do twiddle direto desfaz a rotação do ramo ímpar
+        double wre = fft->rtwiddle[2 * k], wim = -fft->rtwiddle[2 * k + 1];
+        double ore = dre * wre - dim * wim, oim = dre * wim + dim * wre;
+        int r = fft->bitrev[k];
+        // Z = E + iO (aqui 2E e 2O), conjugado para usar a FFT direta como inversa
+        scratch[2 * r] = ere - oim;
+        scratch[2 * r + 1] = -(eim + ore);
+    }
+    fft_complex(fft, scratch);
+
+    for (int k = 0; k < n; k++) {
+        out[2 * k] = scratch[2 * k] * scale;
+        out[2 * k + 1] = -scratch[2 * k + 1] * scale;
+    }
+}
+
+static zend_long gcd_long(zend_long a, zend_long b)
+{
+    while (b) {
+        zend_long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Volta o motor longo ao início de um fluxo: históricos zerados e atraso de grupo descontado
+static void long_filter_restart(psampler_context *ctx)
+{
+    if (ctx->ols) {
+        psampler_ols *ols = ctx->ols;
+        memset(ols->frame, 0, ols->fft.size * sizeof(double));
+        ols->fill = 0;
+        ols->phase = ols->delay;
+    }
+    if (ctx->longfir) {
+        psampler_longfir *lf = ctx->longfir;
+        memset(lf->input, 0, (lf->branch_len - 1) * sizeof(float));
+        lf->input_used = lf->branch_len - 1;
+        lf->phase = lf->delay % lf->interp;
+        lf->next = lf->input_used + lf->delay / lf->interp;
+    }
+    ctx->last_dc = 0.0;
+    ctx->stream_in = 0;
+    ctx->stream_out = 0;
+}
+
+// Passa-baixa na taxa interpolada, corte em 95% do menor Nyquist, ganho L (compensa os zeros inseridos)
+static double *design_long_filter(int taps, zend_long interp, zend_long widest, double beta)
+{
+    double *h = (double *)safe_emalloc(taps, sizeof(double), 0);
+    double cutoff = 0.95 * 0.5 / widest;
+    double center = (taps - 1) / 2.0;
+    double norm = bessel_i0(beta);
+    double sum = 0.0;
+
+    // Kaiser inline: com milhões de taps, recalcular I0(beta) a cada tap dobra o tempo do construtor
+    for (int i = 0; i < taps; i++) {
+        double r = (i - center) / center;
+        h[i] = 2.0 * cutoff * sinc(2.0 * cutoff * (i - center)) * bessel_i0(beta * sqrt(1.0 - r * r)) / norm;
+        sum += h[i];
+    }
+    for (int i = 0; i < taps; i++) {
+        h[i] *= interp / sum;
+    }
+    return h;
+}
+
+static void plan_overlap_save(psampler_context *ctx, const double *h, int taps, zend_long interp, zend_long decim, int size)
+{
+    psampler_ols *ols = (psampler_ols *)emalloc(sizeof(psampler_ols));
+
+    fft_init(&ols->fft, size);
+    ols->interp = (int)interp;
+    ols->decim = (int)decim;
+    ols->taps = taps;
+    ols->block = size - taps + 1;
+    ols->fill = 0;
+    ols->delay = (taps - 1) / 2;
+    ols->phase = ols->delay;
+    ols->spectrum = (double *)safe_emalloc(size + 2, sizeof(double), 0);
+    ols->frame = (double *)ecalloc(size, sizeof(double));
+    ols->work = (double *)safe_emalloc(3 * size + 2, sizeof(double), 0);
+
+    memcpy(ols->work, h, taps * sizeof(double));
+    memset(ols->work + taps, 0, (size - taps) * sizeof(double));
+    fft_forward_real(&ols->fft, ols->work, ols->spectrum, ols->work + size);
+
+    ctx->ols = ols;
+}
+
+static void plan_longfir(psampler_context *ctx, const double *h, int taps, zend_long interp, zend_long decim)
+{
+    psampler_longfir *lf = (psampler_longfir *)emalloc(sizeof(psampler_longfir));
+    int len = (int)((taps + interp - 1) / interp);
+
+    len = (len + 7) & ~7;
+    lf->interp = (int)interp;
+    lf->decim = (int)decim;
+    lf->branch_len = len;
+    lf->delay = (taps - 1) / 2;
+    lf->rows = (float *)safe_emalloc((size_t)interp * len, sizeof(float), 0);
+
+    // Fase p usa h[p], h[p + L], h[p + 2L], ...; a linha é invertida para casar com a
+    // entrada em ordem crescente e completada com zeros no início
+    for (zend_long p = 0; p < interp; p++) {
+        float *row = lf->rows + p * len;
+        for (int t = 0; t < len; t++) {
+            zend_long k = p + (zend_long)(len - 1 - t) * interp;
+            row[t] = (k < taps) ? (float)h[k] : 0.0f;
+        }
+    }
+
+    lf->input_size = (size_t)len * 2;
+    lf->input = (float *)safe_emalloc(lf->input_size, sizeof(float), 0);
+    ctx->longfir = lf;
+    long_filter_restart(ctx);
+}
+
+// Escolhe o motor mais barato por amostra de saída: os ramos fazem branch_len MACs em float;
+// a FFT processa M amostras interpoladas, cada uma custando ~16·log2(N) MACs (medido)
+static int long_filter_prefers_fft(int taps, zend_long interp, zend_long decim, int size)
+{
+    double branch_cost = (double)((taps + interp - 1) / interp);
+    double fft_cost = LONG_FILTER_FFT_WEIGHT * decim * log2((double)size);
+
+    return taps <= FFT_MAX_TAPS && fft_cost < branch_cost;
+}
+
+static int plan_long_filter(psampler_context *ctx, zend_long src, zend_long dst, int quality)
+{
+    if (src <= 0 || dst <= 0) {
+        return 0;
+    }
+
+    zend_long g = gcd_long(src, dst);
+    zend_long interp = dst / g;
+    zend_long decim = src / g;
+    zend_long widest = interp > decim ? interp : decim;
+    zend_long taps = (quality == PSAMPLER_QUALITY_OFFLINE ? FFT_TAPS_OFFLINE : FFT_TAPS_HIGH) * widest;
+    double beta = (quality == PSAMPLER_QUALITY_OFFLINE) ? KAISER_BETA_OFFLINE : KAISER_BETA;
+
+    // Razões com L e M enormes (ex.: 44100 -> 44099) não cabem nem nos ramos: avisa e encurta
+    if (taps > LONGFIR_MAX_TAPS) {
+        php_error_docref(NULL, E_WARNING, "Filter for " ZEND_LONG_FMT " -> " ZEND_LONG_FMT " Hz truncated from " ZEND_LONG_FMT " to %d taps, quality is reduced",
+            src, dst, taps, LONGFIR_MAX_TAPS);
+        taps = LONGFIR_MAX_TAPS;
+    }
+    taps |= 1; // comprimento ímpar: atraso de grupo inteiro
+
+    int size = 2;
+    while (size < 4 * taps) size *= 2;
+
+    double *h = design_long_filter((int)taps, interp, widest, beta);
+    if (long_filter_prefers_fft((int)taps, interp, decim, size)) {
+        plan_overlap_save(ctx, h, (int)taps, interp, decim, size);
+    } else {
+        plan_longfir(ctx, h, (int)taps, interp, decim);
+    }
+    efree(h);
+    return 1;
+}
+
+static void free_overlap_save(psampler_ols *ols)
+{
+    fft_free(&ols->fft);
+    efree(ols->spectrum);
+    efree(ols->frame);
+    efree(ols->work);
+    efree(ols);
+}
+
+static void free_longfir(psampler_longfir *lf)
+{
+    efree(lf->rows);
+    efree(lf->input);
+    efree(lf);
+}
+
+static psampler_context *create_context(double src_rate, double dst_rate, int quality)
+{
+    psampler_context *ctx = (psampler_context *)emalloc(sizeof(psampler_context));
+    ctx->src_rate = src_rate;
+    ctx->dst_rate = dst_rate;
+    ctx->ratio = dst_rate / src_rate;
+    ctx->last_dc = 0.0;
+    ctx->frac_pos = 0.0;
+    
+    // O buffer de entrada só é alocado pelo caminho polyphase, no primeiro bloco
+    ctx->buffer_size = 0;
+    ctx->buffer_used = 0;
+    ctx->input_buffer = NULL;
+    
+    ctx->bank = NULL;
+    ctx->cascade_stages = 0;
+    ctx->cascade = NULL;
+    ctx->cascade_out = NULL;
+    ctx->cascade_scratch = NULL;
+    ctx->cascade_out_size = 0;
+    ctx->cascade_scratch_size = 0;
+    ctx->cascade_skip = 0;
+    ctx->ols = NULL;
+    ctx->longfir = NULL;
+    ctx->stream_in = 0;
+    ctx->stream_out = 0;
+    ctx->silence_threshold = 0;
+    ctx->loud_end = 0;
+    ctx->quiet_run = 0;
+    ctx->cascade_settle = 0;
+    ctx->silent_samples = 0;
+    ctx->next = NULL;
+
+    // HIGH/OFFLINE usam o filtro longo (FFT ou ramos polyphase); razões inteiras com
+    // fatores 2 e 3 dispensam o banco polyphase
+    if (quality != PSAMPLER_QUALITY_DEFAULT) {
+        plan_long_filter(ctx, (zend_long)src_rate, (zend_long)dst_rate, quality);
+    }
+    if (!ctx->ols && !ctx->longfir && !plan_cascade(ctx, (zend_long)src_rate, (zend_long)dst_rate)) {
+        ctx->bank = bank_acquire(ctx->ratio);
+    }
+
+    return ctx;
+}
+
+static void free_context(psampler_context *ctx)
+{
+    if (ctx->input_buffer) {
+        efree(ctx->input_buffer);
+    }
+    if (ctx->bank) {
+        bank_release(ctx->bank);
+    }
+    if (ctx->cascade) {
+        for (int s = 0; s < ctx->cascade_stages; s++) {
+            if (ctx->cascade[s].buf) {
+                efree(ctx->cascade[s].buf);
+            }
+        }
+        efree(ctx->cascade);
+    }
+    if (ctx->cascade_out) {
+        efree(ctx->cascade_out);
+    }
+    if (ctx->cascade_scratch) {
+        efree(ctx->cascade_scratch);
+    }
+    if (ctx->ols) {
+        free_overlap_save(ctx->ols);
+    }
+    if (ctx->longfir) {
+        free_longfir(ctx->longfir);
+    }
+    efree(ctx);
+}
+
+// Remoção de DC offset (filtro passa-alta de 1 polo na taxa de saída) e saturação em 16 bits
+static inline int16_t remove_dc_and_clip(double *last_dc, double sample)
+{
+    *last_dc = 0.9995 * *last_dc + 0.0005 * sample;
+    sample -= *last_dc;
+    
+    if (sample > 32767.0) sample = 32767.0;
+    else if (sample < -32768.0) sample = -32768.0;
+    
+#ifdef __SSE2__
+    // Mesmo arredondamento de lrint (modo corrente do MXCSR), sem a chamada à libm por amostra
+    return (int16_t)_mm_cvtsd_si32(_mm_set_sd(sample));
+#else
+    return (int16_t)lrint(sample);
+#endif
+}
+
+static inline int16_t finish_sample(psampler_context *ctx, double sample)
+{
+    return remove_dc_and_clip(&ctx->last_dc, sample);
+}
+
+// Limite superior de amostras de saída geradas por n amostras de entrada
+static size_t context_output_bound(psampler_context *ctx, size_t n)
+{
+    if (ctx->ols) {
+        psampler_ols *ols = ctx->ols;
+        size_t blocks = (ols->fill + n * ols->interp) / ols->block;
+        return blocks * (ols->block / ols->decim + 1);
+    }
+    
+    if (ctx->longfir) {
+        psampler_longfir *lf = ctx->longfir;
+        size_t last = lf->input_used + n;
+        if (lf->next >= last) {
+            return 0;
+        }
+        return (size_t)((uint64_t)(last - lf->next) * lf->interp / lf->decim) + 1;
+    }
+    
+    if (ctx->cascade_stages > 0) {
+        size_t len = n;
+        for (int s = 0; s < ctx->cascade_stages; s++) {
+            int factor = stage_factor(ctx->cascade[s].kind);
+            len = stage_is_up(ctx->cascade[s].kind) ? len * factor : len / factor + 1;
+        }
+        return len;
+    }
+    
+    // Entrada ainda não consumida (além do histórico) mais o bloco novo
+    size_t available = (ctx->buffer_used > FILTER_HALF ? ctx->buffer_used - FILTER_HALF : 0) + n;
+    return (size_t)(available * ctx->ratio) + 2;
+}
+
+// Índice + 1 da última amostra com |x| > threshold (0 se o bloco todo é silencioso)
+static size_t last_loud_index(const int16_t *x, size_t n, int threshold)
+{
+    size_t i = n;
+    
+    // Limiar negativo desliga o caminho rápido: todo bloco conta como audível
+    if (threshold < 0) {
+        return n;
+    }
+#ifdef __SSE2__
+    __m128i limit = _mm_set1_epi16((short)threshold);
+    __m128i zero = _mm_setzero_si128();
+    
+    // Varre de trás para frente em blocos de 8; |x| sem sinal evita o overflow de -32768
+    while (i >= 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(x + i - 8));
+        __m128i mag = _mm_max_epi16(v, _mm_sub_epi16(zero, v));
+        __m128i over = _mm_subs_epu16(mag, limit);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(over, zero)) != 0xFFFF) {
+            break;
+        }
+        i -= 8;
+    }
+#endif
+    while (i > 0) {
+        i--;
+        if (abs(x[i]) > threshold) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// Avança um estágio sobre n amostras nulas sem filtrar; devolve quantas sairiam
+static size_t stage_skip_silence(psampler_stage *st, size_t n)
+{
+    int factor = stage_factor(st->kind);
+    size_t count;
+    
+    if (st->buf) {
+        memset(st->buf, 0, st->history_len * sizeof(float));
+    }
+    if (stage_is_up(st->kind)) {
+        return n * factor;
+    }
+    count = ((size_t)st->phase < n) ? (n - st->phase + factor - 1) / factor : 0;
+    st->phase = (int)(st->phase + factor * count - n);
+    return count;
+}
+
+// Cresce um buffer float da cascata; na primeira alocação zera os keep primeiros
+static float *cascade_grow(float *buf, size_t *size, size_t needed, size_t keep)
+{
+    if (needed > *size) {
+        size_t grown = (needed + 63) & ~(size_t)63;
+        int fresh = (buf == NULL);
+        buf = (float *)safe_erealloc(buf, grown, sizeof(float), 0);
+        if (fresh) {
+            memset(buf, 0, keep * sizeof(float));
+        }
+        *size = grown;
+    }
+    return buf;
+}
+
+// Garante os buffers de todos os estágios para um bloco de n amostras de entrada
+static void cascade_reserve(psampler_context *ctx, size_t n)
+{
+    size_t len = n;
+    
+    for (int s = 0; s < ctx->cascade_stages; s++) {
+        psampler_stage *st = &ctx->cascade[s];
+        size_t hist = (size_t)st->history_len;
+        int factor = stage_factor(st->kind);
+        
+        st->buf = cascade_grow(st->buf, &st->buf_size, hist + len, hist);
+        if (!stage_is_up(st->kind)) {
+            ctx->cascade_scratch = cascade_grow(ctx->cascade_scratch, &ctx->cascade_scratch_size,
+                hist + len + 2 * HALFBAND_NONZERO, 0);
+        }
+        len = stage_is_up(st->kind) ? len * factor : len / factor + 1;
+    }
+    ctx->cascade_out = cascade_grow(ctx->cascade_out, &ctx->cascade_out_size, len, 0);
+}
+
+// Consome até len saídas do atraso inicial ainda não descartado; devolve quantas
+static inline size_t cascade_drop_delay(psampler_context *ctx, size_t len)
+{
+    size_t skip = (ctx->cascade_skip < len) ? ctx->cascade_skip : len;
+    ctx->cascade_skip -= skip;
+    return skip;
+}
+
+static size_t cascade_process(psampler_context *ctx, const int16_t *in, size_t n, int16_t *out)
+{
+    size_t len;
+    
+    // Bloco silencioso com históricos já assentados: só avança as fases e emite a cauda do DC
+    size_t loud = last_loud_index(in, n, ctx->silence_threshold);
+    if (loud == 0 && ctx->quiet_run >= ctx->cascade_settle) {
+        len = n;
+        for (int s = 0; s < ctx->cascade_stages; s++) {
+            len = stage_skip_silence(&ctx->cascade[s], len);
+        }
+        len -= cascade_drop_delay(ctx, len);
+        for (size_t i = 0; i < len; i++) {
+            out[i] = finish_sample(ctx, 0.0);
+        }
+        ctx->quiet_run += n;
+        ctx->silent_samples += (zend_long)len;
+        return len;
+    }
+    ctx->quiet_run = (loud == 0) ? ctx->quiet_run + n : n - loud;
+    
+    // Buffers ficam no contexto: em regime só crescem se o bloco aumentar
+    cascade_reserve(ctx, n);
+    
+    float *x = ctx->cascade[0].buf + ctx->cascade[0].history_len;
+    for (size_t i = 0; i < n; i++) {
+        x[i] = in[i];
+    }
+    
+    // Cada estágio escreve direto depois do histórico do próximo
+    len = n;
+    for (int s = 0; s < ctx->cascade_stages; s++) {
+        float *dst = (s + 1 < ctx->cascade_stages)
+            ? ctx->cascade[s + 1].buf + ctx->cascade[s + 1].history_len
+            : ctx->cascade_out;
+        len = stage_run(&ctx->cascade[s], len, dst, ctx->cascade_scratch);
+    }
+    
+    size_t skip = cascade_drop_delay(ctx, len);
+    for (size_t i = skip; i < len; i++) {
+        out[i - skip] = finish_sample(ctx, ctx->cascade_out[i]);
+    }
+    return len - skip;
+}
+
+// Filtra o bloco cheio e decima as amostras válidas direto para a saída
+static size_t ols_run_block(psampler_context *ctx, int16_t *out)
+{
+    psampler_ols *ols = ctx->ols;
+    int size = ols->fft.size;
+    int bins = ols->fft.half + 1;
+    double *spec = ols->work;
+    double *filtered = spec + size + 2;
+    double *scratch = filtered + size;
+    size_t produced = 0;
+    int p;
+
+    fft_forward_real(&ols->fft, ols->frame, spec, scratch);
+    for (int k = 0; k < bins; k++) {
+        double xre = spec[2 * k], xim = spec[2 * k + 1];
+        double hre = ols->spectrum[2 * k], him = ols->spectrum[2 * k + 1];
+        spec[2 * k] = xre * hre - xim * him;
+        spec[2 * k + 1] = xre * him + xim * hre;
+    }
+    fft_inverse_real(&ols->fft, spec, filtered, scratch);
+
+    // Só as últimas block amostras não sofrem aliasing circular
+    for (p = ols->phase; p < ols->block; p += ols->decim) {
+        out[produced++] = finish_sample(ctx, filtered[ols->taps - 1 + p]);
+    }
+    ols->phase = p - ols->block;
+
+    memmove(ols->frame, ols->frame + ols->block, (ols->taps - 1) * sizeof(double));
+    ols->fill = 0;
+    return produced;
+}
+
+static size_t ols_process(psampler_context *ctx, const int16_t *in, size_t n, int16_t *out)
+{
+    psampler_ols *ols = ctx->ols;
+    double *frame = ols->frame + ols->taps - 1;
+    size_t produced = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        // Inserção de zeros: uma amostra real seguida de L - 1 zeros
+        for (int r = 0; r < ols->interp; r++) {
+            frame[ols->fill++] = (r == 0) ? (double)in[i] : 0.0;
+            if (ols->fill == ols->block) {
+                produced += ols_run_block(ctx, out + produced);
+            }
+        }
+    }
+    return produced;
+}
+
+// Completa os blocos com zeros até emitir remaining amostras; out precisa de
+// remaining + block / decim + 1 posições
+static size_t ols_flush(psampler_context *ctx, size_t remaining, int16_t *out)
+{
+    psampler_ols *ols = ctx->ols;
+    double *frame = ols->frame + ols->taps - 1;
+    size_t produced = 0;
+
+    while (produced < remaining) {
+        memset(frame + ols->fill, 0, (ols->block - ols->fill) * sizeof(double));
+        ols->fill = ols->block;
+        produced += ols_run_block(ctx, out + produced);
+    }
+    return remaining;
+}
+
+// Acrescenta n amostras (zeros se in == NULL) ao fim da entrada dos ramos
+static void longfir_append(psampler_longfir *lf, const int16_t *in, size_t n)
+{
+    size_t needed = lf->input_used + n;
+    if (needed > lf->input_size) {
+        size_t size = (needed + 63) & ~(size_t)63;
+        lf->input = (float *)safe_erealloc(lf->input, size, sizeof(float), 0);
+        lf->input_size = size;
+    }
+
+    float *dst = lf->input + lf->input_used;
+    if (in) {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = in[i];
+        }
+    } else {
+        memset(dst, 0, n * sizeof(float));
+    }
+    lf->input_used += n;
+}
+
+// Emite até limit saídas com a entrada disponível e descarta o que nenhuma saída futura usa
+static size_t longfir_run(psampler_context *ctx, int16_t *out, size_t limit)
+{
+    psampler_longfir *lf = ctx->longfir;
+    size_t step = (size_t)(lf->decim / lf->interp);
+    int step_phase = lf->decim % lf->interp;
+    size_t produced = 0;
+
+    while (lf->next < lf->input_used && produced < limit) {
+        const float *x = lf->input + lf->next + 1 - lf->branch_len;
+        const float *row = lf->rows + (size_t)lf->phase * lf->branch_len;
+        out[produced++] = finish_sample(ctx, fir_dot(row, x, lf->branch_len));
+
+        lf->next += step;
+        lf->phase += step_phase;
+        if (lf->phase >= lf->interp) {
+            lf->phase -= lf->interp;
+            lf->next++;
+        }
+    }
+
+    size_t drop = lf->next + 1 - lf->branch_len;
+    if (drop > lf->input_used) {
+        drop = lf->input_used;
+    }
+    if (drop > 0) {
+        memmove(lf->input, lf->input + drop, (lf->input_used - drop) * sizeof(float));
+        lf->input_used -= drop;
+        lf->next -= drop;
+    }
+    return produced;
+}
+
+static size_t longfir_process(psampler_context *ctx, const int16_t *in, size_t n, int16_t *out)
+{
+    longfir_append(ctx->longfir, in, n);
+    return longfir_run(ctx, out, SIZE_MAX);
+}
+
+// Alimenta zeros até emitir exatamente remaining amostras
+static size_t longfir_flush(psampler_context *ctx, size_t remaining, int16_t *out)
+{
+    psampler_longfir *lf = ctx->longfir;
+    size_t produced = 0;
+
+    while (produced < remaining) {
+        longfir_append(lf, NULL, lf->next + 1 - lf->input_used);
+        produced += longfir_run(ctx, out + produced, remaining - produced);
+    }
+    return produced;
+}
+
+// Produto escalar de FILTER_LENGTH amostras com uma linha do banco; reverse percorre a linha ao contrário
+static inline double poly_dot(const int16_t *x, const float *c, int reverse)
+{
+#ifdef __SSE2__
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    
+    for (int j = 0; j < FILTER_LENGTH; j += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(x + j));
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+        __m128 c0, c1;
+        
+        if (reverse) {
+            c0 = _mm_shuffle_ps(_mm_loadu_ps(c + FILTER_LENGTH - 4 - j), _mm_loadu_ps(c + FILTER_LENGTH - 4 - j), 0x1B);
+            c1 = _mm_shuffle_ps(_mm_loadu_ps(c + FILTER_LENGTH - 8 - j), _mm_loadu_ps(c + FILTER_LENGTH - 8 - j), 0x1B);
+        } else {
+            c0 = _mm_loadu_ps(c + j);
+            c1 = _mm_loadu_ps(c + j + 4);
+        }
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(lo, c0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(hi, c1));
+    }
+    
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+    return (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+    float sum = 0.0f;
+    
+    if (reverse) {
+        for (int j = 0; j < FILTER_LENGTH; j++) {
+            sum += x[j] * c[FILTER_LENGTH - 1 - j];
+        }
+    } else {
+        for (int j = 0; j < FILTER_LENGTH; j++) {
+            sum += x[j] * c[j];
+        }
+    }
+    return sum;
+#endif
+}
+
+static size_t polyphase_process(psampler_context *ctx, const int16_t *new_samples, size_t new_count, int16_t *out)
+{
+    double step = 1.0 / ctx->ratio;
+    size_t out_count = 0;
+    
+    // Primeiro bloco: FILTER_HALF zeros de histórico antes da amostra 0
+    if (!ctx->input_buffer) {
+        ctx->buffer_size = FILTER_LENGTH;
+        ctx->input_buffer = (int16_t *)ecalloc(ctx->buffer_size, sizeof(int16_t));
+        ctx->buffer_used = FILTER_HALF;
+        ctx->frac_pos += FILTER_HALF;
+    }
+    
+    while (new_count > 0) {
+        // Blocos enormes são processados em pedaços de até MAX_BUFFER_SIZE
+        size_t to_copy = (new_count < MAX_BUFFER_SIZE) ? new_count : MAX_BUFFER_SIZE;
+        
+        // Cresce só até o bloco observado + histórico; +2 cobre a leitura das fases invertidas
+        size_t needed = ctx->buffer_used + to_copy + 2;
+        if (needed > ctx->buffer_size) {
+            size_t size = (needed + 63) & ~(size_t)63;
+            ctx->input_buffer = (int16_t *)safe_erealloc(ctx->input_buffer, size, sizeof(int16_t), 0);
+            memset(ctx->input_buffer + ctx->buffer_size, 0, (size - ctx->buffer_size) * sizeof(int16_t));
+            ctx->buffer_size = size;
+        }
+        
+        size_t loud = last_loud_index(new_samples, to_copy, ctx->silence_threshold);
+        if (loud > 0) {
+            ctx->loud_end = ctx->buffer_used + loud;
+        }
+        memcpy(ctx->input_buffer + ctx->buffer_used, new_samples, to_copy * sizeof(int16_t));
+        ctx->buffer_used += to_copy;
+        new_samples += to_copy;
+        new_count -= to_copy;
+        
+        // Processa com filtro polyphase de alta qualidade
+        for (;;) {
+            size_t base_idx = (size_t)ctx->frac_pos;
+            
+            // Verifica se temos amostras suficientes no buffer
+            if (base_idx + FILTER_HALF >= ctx->buffer_used) {
+                break;
+            }
+            
+            // Janela inteira depois da última amostra audível: a convolução daria zero
+            if (base_idx - FILTER_HALF >= ctx->loud_end) {
+                out[out_count++] = finish_sample(ctx, 0.0);
+                ctx->frac_pos += step;
+                ctx->silent_samples++;
+                continue;
+            }
+            
+            // Fases acima da metade usam a linha espelhada: h(d) é par
+            int phase = (int)((ctx->frac_pos - base_idx) * FILTER_PHASES);
+            if (phase >= FILTER_PHASES) phase = FILTER_PHASES - 1;
+            
+            const int16_t *window = ctx->input_buffer + base_idx - FILTER_HALF;
+            double sample;
+            
+            if (phase <= FILTER_PHASES / 2) {
+                sample = poly_dot(window, ctx->bank->rows + phase * FILTER_LENGTH, 0);
+            } else {
+                sample = poly_dot(window + 2, ctx->bank->rows + (FILTER_PHASES - phase) * FILTER_LENGTH, 1);
+            }
+            
+            out[out_count++] = finish_sample(ctx, sample);
+            ctx->frac_pos += step;
+        }
+        
+        // Remove amostras processadas do buffer, mantendo FILTER_HALF de histórico
+        size_t base_idx = (size_t)ctx->frac_pos;
+        if (base_idx > FILTER_HALF) {
+            size_t consumed = base_idx - FILTER_HALF;
+            if (consumed > ctx->buffer_used) {
+                consumed = ctx->buffer_used;
+            }
+            ctx->frac_pos -= consumed;
+            memmove(ctx->input_buffer, ctx->input_buffer + consumed,
+                    (ctx->buffer_used - consumed) * sizeof(int16_t));
+            ctx->buffer_used -= consumed;
+            ctx->loud_end = (ctx->loud_end > consumed) ? ctx->loud_end - consumed : 0;
+        }
+    }
+    
+    return out_count;
+}
+
+// ============================================================================
+// Fan-out: uma entrada, várias taxas de saída
+// ============================================================================
+
+// Igual a poly_dot, mas sobre o histórico float do fan-out
+static inline double poly_dot_float(const float *x, const float *c, int reverse)
+{
+#ifdef __SSE2__
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    
+    for (int j = 0; j < FILTER_LENGTH; j += 8) {
+        __m128 c0, c1;
+        
+        if (reverse) {
+            c0 = _mm_shuffle_ps(_mm_loadu_ps(c + FILTER_LENGTH - 4 - j), _mm_loadu_ps(c + FILTER_LENGTH - 4 - j), 0x1B);
+            c1 = _mm_shuffle_ps(_mm_loadu_ps(c + FILTER_LENGTH - 8 - j), _mm_loadu_ps(c + FILTER_LENGTH - 8 - j), 0x1B);
+        } else {
+            c0 = _mm_loadu_ps(c + j);
+            c1 = _mm_loadu_ps(c + j + 4);
+        }
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + j), c0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + j + 4), c1));
+    }
+    
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+    return (double)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#else
+    float sum = 0.0f;
+    
+    if (reverse) {
+        for (int j = 0; j < FILTER_LENGTH; j++) {
+            sum += x[j] * c[FILTER_LENGTH - 1 - j];
+        }
+    } else {
+        for (int j = 0; j < FILTER_LENGTH; j++) {
+            sum += x[j] * c[j];
+        }
+    }
+    return sum;
+#endif
+}
+
+static psampler_fanout *create_fanout(zend_long src_rate, const zend_long *dst_rates, int count, int silence_threshold)
+{
+    psampler_fanout *fan = (psampler_fanout *)emalloc(sizeof(psampler_fanout));
+    
+    fan->src_rate = src_rate;
+    fan->branch_count = count;
+    fan->silence_threshold = silence_threshold;
+    fan->loud_end = 0;
+    fan->silent_samples = 0;
+    
+    // FILTER_HALF zeros de histórico antes da amostra 0, como no polyphase
+    fan->buffer_size = FILTER_LENGTH;
+    fan->buffer_used = FILTER_HALF;
+    fan->input_buffer = (float *)ecalloc(fan->buffer_size, sizeof(float));
+    
+    for (int b = 0; b < count; b++) {
+        psampler_branch *branch = &fan->branches[b];
+        branch->dst_rate = dst_rates[b];
+        branch->ratio = (double)dst_rates[b] / (double)src_rate;
+        branch->frac_pos = FILTER_HALF;
+        branch->last_dc = 0.0;
+        branch->bank = bank_acquire(branch->ratio);
+    }
+    
+    return fan;
+}
+
+static void free_fanout(psampler_fanout *fan)
+{
+    for (int b = 0; b < fan->branch_count; b++) {
+        bank_release(fan->branches[b].bank);
+    }
+    efree(fan->input_buffer);
+    efree(fan);
+}
+
+static int fanout_matches(const psampler_fanout *fan, zend_long src_rate, const zend_long *dst_rates, int count)
+{
+    if (fan->src_rate != src_rate || fan->branch_count != count) {
+        return 0;
+    }
+    for (int b = 0; b < count; b++) {
+        if (fan->branches[b].dst_rate != dst_rates[b]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Limite superior de saídas de uma taxa para n amostras novas
+static size_t fanout_output_bound(const psampler_fanout *fan, int b, size_t n)
+{
+    size_t available = (fan->buffer_used > FILTER_HALF ? fan->buffer_used - FILTER_HALF : 0) + n;
+    return (size_t)(available * fan->branches[b].ratio) + 2;
+}
+
+// Converte a entrada uma vez e roda todas as taxas sobre o mesmo trecho em cache
+static void fanout_process(psampler_fanout *fan, const int16_t *in, size_t n, int16_t **outs, size_t *counts)
+{
+    for (int b = 0; b < fan->branch_count; b++) {
+        counts[b] = 0;
+    }
+    
+    while (n > 0) {
+        size_t to_copy = (n < MAX_BUFFER_SIZE) ? n : MAX_BUFFER_SIZE;
+        size_t needed = fan->buffer_used + to_copy + 2;
+        
+        if (needed > fan->buffer_size) {
+            size_t size = (needed + 63) & ~(size_t)63;
+            fan->input_buffer = (float *)safe_erealloc(fan->input_buffer, size, sizeof(float), 0);
+            memset(fan->input_buffer + fan->buffer_size, 0, (size - fan->buffer_size) * sizeof(float));
+            fan->buffer_size = size;
+        }
+        
+        size_t loud = last_loud_index(in, to_copy, fan->silence_threshold);
+        if (loud > 0) {
+            fan->loud_end = fan->buffer_used + loud;
+        }
+        
+        // Conversão para float feita uma única vez, na taxa de entrada
+        float *dst = fan->input_buffer + fan->buffer_used;
+        for (size_t i = 0; i < to_copy; i++) {
+            dst[i] = in[i];
+        }
+        fan->buffer_used += to_copy;
+        in += to_copy;
+        n -= to_copy;
+        
+        size_t consumed = fan->buffer_used;
+        
+        for (int b = 0; b < fan->branch_count; b++) {
+            psampler_branch *branch = &fan->branches[b];
+            double step = 1.0 / branch->ratio;
+            int16_t *out = outs[b];
+            size_t count = counts[b];
+            
+            for (;;) {
+                size_t base_idx = (size_t)branch->frac_pos;
+                if (base_idx + FILTER_HALF >= fan->buffer_used) {
+                    break;
+                }
+                
+                if (base_idx - FILTER_HALF >= fan->loud_end) {
+                    out[count++] = remove_dc_and_clip(&branch->last_dc, 0.0);
+                    branch->frac_pos += step;
+                    fan->silent_samples++;
+                    continue;
+                }
+                
+                int phase = (int)((branch->frac_pos - base_idx) * FILTER_PHASES);
+                if (phase >= FILTER_PHASES) phase = FILTER_PHASES - 1;
+                
+                const float *window = fan->input_buffer + base_idx - FILTER_HALF;
+                double sample;
+                
+                if (phase <= FILTER_PHASES / 2) {
+                    sample = poly_dot_float(window, branch->bank->rows + phase * FILTER_LENGTH, 0);
+                } else {
+                    sample = poly_dot_float(window + 2, branch->bank->rows + (FILTER_PHASES - phase) * FILTER_LENGTH, 1);
+                }
+                
+                out[count++] = remove_dc_and_clip(&branch->last_dc, sample);
+                branch->frac_pos += step;
+            }
+            counts[b] = count;
+            
+            // O histórico só pode avançar até a taxa mais atrasada
+            size_t base_idx = (size_t)branch->frac_pos;
+            size_t done = (base_idx > FILTER_HALF) ? base_idx - FILTER_HALF : 0;
+            if (done < consumed) {
+                consumed = done;
+            }
+        }
+        
+        if (consumed > 0) {
+            memmove(fan->input_buffer, fan->input_buffer + consumed,
+                    (fan->buffer_used - consumed) * sizeof(float));
+            fan->buffer_used -= consumed;
+            fan->loud_end = (fan->loud_end > consumed) ? fan->loud_end - consumed : 0;
+            for (int b = 0; b < fan->branch_count; b++) {
+                fan->branches[b].frac_pos -= consumed;
+            }
+        }
+    }
+}
+
+// Processa um bloco de entrada; out precisa de context_output_bound() amostras
+static size_t context_process(psampler_context *ctx, const int16_t *in, size_t n, int16_t *out)
+{
+    if (ctx->ols || ctx->longfir) {
+        size_t produced = ctx->ols ? ols_process(ctx, in, n, out) : longfir_process(ctx, in, n, out);
+        ctx->stream_in += n;
+        ctx->stream_out += produced;
+        return produced;
+    }
+    if (ctx->cascade_stages > 0) {
+        return cascade_process(ctx, in, n, out);
+    }
+    return polyphase_process(ctx, in, n, out);
+}
+
+// Saída que ainda falta para fechar o fluxo de um preset HIGH/OFFLINE: ceil(entrada * L / M) - emitida
+static size_t long_filter_pending(psampler_context *ctx)
+{
+    uint64_t interp = ctx->ols ? ctx->ols->interp : ctx->longfir->interp;
+    uint64_t decim = ctx->ols ? ctx->ols->decim : ctx->longfir->decim;
+    uint64_t total = (ctx->stream_in * interp + decim - 1) / decim;
+
+    return total > ctx->stream_out ? (size_t)(total - ctx->stream_out) : 0;
+}
+
+// ============================================================================
+// Analyzer: estatísticas de qualidade em uma passada sobre PCM 16-bit
+// ============================================================================
+
+// Soma, soma dos quadrados, pico, clipping e cruzamentos por zero de x[0..n)
+static void analyzer_scan(analyzer_object *an, const int16_t *x, size_t n)
+{
+    int64_t sum = 0;
+    uint64_t sum_sq = 0;
+    int peak = an->peak;
+    zend_long clipped = 0, crossings = 0;
+    size_t i = 0;
+    
+    // Primeira amostra compara com a última do bloco anterior
+    if (n > 0 && an->samples > 0 && ((x[0] ^ an->last) < 0)) {
+        crossings++;
+    }
+    
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i bias = _mm_set1_epi16((short)0x8000);
+    const __m128i clip_floor = _mm_set1_epi16((short)(an->clip_threshold - 1));
+    
+    // Começa em 1 para que x[i - 1] seja sempre válido na contagem de cruzamentos
+    i = 1;
+    while (i + 8 <= n) {
+        // Blocos limitados mantêm os acumuladores de 16/32 bits sem overflow
+        size_t block_end = i + 8 * 4096;
+        if (block_end > n) block_end = n;
+        
+        __m128i acc_sum = zero, acc_sq = zero, acc_clip = zero, acc_cross = zero;
+        __m128i acc_peak = _mm_xor_si128(_mm_set1_epi16((short)peak), bias);
+        
+        for (; i + 8 <= block_end; i += 8) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(x + i));
+            __m128i prev = _mm_loadu_si128((const __m128i *)(x + i - 1));
+            
+            acc_sum = _mm_add_epi32(acc_sum, _mm_madd_epi16(v, ones));
+            
+            // v² de pares pode chegar a 2^31: estende sem sinal para 64 bits
+            __m128i sq = _mm_madd_epi16(v, v);
+            acc_sq = _mm_add_epi64(acc_sq, _mm_unpacklo_epi32(sq, zero));
+            acc_sq = _mm_add_epi64(acc_sq, _mm_unpackhi_epi32(sq, zero));
+            
+            // |x| sem sinal (-32768 vira 32768); max sem sinal via deslocamento do bit de sinal
+            __m128i mag = _mm_max_epi16(v, _mm_sub_epi16(zero, v));
+            acc_peak = _mm_max_epi16(acc_peak, _mm_xor_si128(mag, bias));
+            acc_clip = _mm_sub_epi16(acc_clip, _mm_xor_si128(_mm_cmpeq_epi16(_mm_subs_epu16(mag, clip_floor), zero), _mm_cmpeq_epi16(zero, zero)));
+            
+            acc_cross = _mm_sub_epi16(acc_cross, _mm_srai_epi16(_mm_xor_si128(v, prev), 15));
+        }
+        
+        int32_t s32[4];
+        int64_t s64[2];
+        int16_t s16[8];
+        
+        _mm_storeu_si128((__m128i *)s32, acc_sum);
+        sum += (int64_t)s32[0] + s32[1] + s32[2] + s32[3];
+        _mm_storeu_si128((__m128i *)s64, acc_sq);
+        sum_sq += (uint64_t)s64[0] + (uint64_t)s64[1];
+        
+        _mm_storeu_si128((__m128i *)s16, _mm_xor_si128(acc_peak, bias));
+        for (int k = 0; k < 8; k++) {
+            if ((uint16_t)s16[k] > peak) peak = (uint16_t)s16[k];
+        }
+        _mm_storeu_si128((__m128i *)s16, acc_clip);
+        for (int k = 0; k < 8; k++) clipped += (uint16_t)s16[k];
+        _mm_storeu_si128((__m128i *)s16, acc_cross);
+        for (int k = 0; k < 8; k++) crossings += (uint16_t)s16[k];
+    }
+    
+    // x[0] ainda não foi contado pelo laço vetorial
+    if (n > 0) {
+        int mag = abs(x[0]);
+        sum += x[0];
+        sum_sq += (uint64_t)((int64_t)x[0] * x[0]);
+        if (mag > peak) peak = mag;
+        if (mag >= an->clip_threshold) clipped++;
+    }
+#endif
+    
+    for (; i < n; i++) {
+        int mag = abs(x[i]);
+        sum += x[i];
+        sum_sq += (uint64_t)((int64_t)x[i] * x[i]);
+        if (mag > peak) peak = mag;
+        if (mag >= an->clip_threshold) clipped++;
+        if (i > 0 && ((x[i] ^ x[i - 1]) < 0)) crossings++;
+    }
+    
+    an->sum += sum;
+    an->sum_sq += sum_sq;
+    an->peak = peak;
+    an->clipped += clipped;
+    an->crossings += crossings;
+    if (n > 0) {
+        an->last = x[n - 1];
+        an->samples += (zend_long)n;
+    }
+}
+
+// Acumula a energia por banda do quadro atual (janela Hann + FFT real)
+static void analyzer_spectrum(analyzer_object *an)
+{
+    int size = an->fft_size;
+    double *frame = an->work;
+    double *spec = an->work + size;
+    double *scratch = spec + size + 2;
+    
+    for (int i = 0; i < size; i++) {
+        frame[i] *= an->window[i];
+    }
+    fft_forward_real(&an->fft, frame, spec, scratch);
+    
+    for (int k = 0; k <= size / 2; k++) {
+        an->band_energy[an->bin_band[k]] += spec[2 * k] * spec[2 * k] + spec[2 * k + 1] * spec[2 * k + 1];
+    }
+    an->frames++;
+}
+
+static void analyzer_update(analyzer_object *an, const int16_t *x, size_t n)
+{
+    analyzer_scan(an, x, n);
+    
+    // Sem bordas de banda não há espectro a medir
+    if (an->edge_count == 0) {
+        return;
+    }
+    
+    // Espectro em quadros sem sobreposição, completados entre chamadas
+    while (n > 0) {
+        size_t take = (size_t)(an->fft_size - an->fill);
+        if (take > n) take = n;
+        
+        double *frame = an->work + an->fill;
+        for (size_t i = 0; i < take; i++) {
+            frame[i] = x[i];
+        }
+        an->fill += (int)take;
+        x += take;
+        n -= take;
+        
+        if (an->fill == an->fft_size) {
+            analyzer_spectrum(an);
+            an->fill = 0;
+        }
+    }
+}
+
+static void analyzer_reset(analyzer_object *an)
+{
+    an->fill = 0;
+    an->samples = 0;
+    an->clipped = 0;
+    an->crossings = 0;
+    an->sum = 0;
+    an->sum_sq = 0;
+    an->peak = 0;
+    an->last = 0;
+    an->frames = 0;
+    memset(an->band_energy, 0, sizeof(an->band_energy));
+}
+
+static void analyzer_release_buffers(analyzer_object *an)
+{
+    if (an->window) {
+        fft_free(&an->fft);
+        efree(an->window);
+        efree(an->work);
+        efree(an->bin_band);
+        an->window = NULL;
+        an->work = NULL;
+        an->bin_band = NULL;
+    }
+}
+
+// (Re)aloca os buffers para uma nova configuração; bordas em Hz, crescentes
+static void analyzer_configure(analyzer_object *an, int sample_rate, int fft_size, const double *edges, int edge_count, int clip_threshold)
+{
+    analyzer_release_buffers(an);
+    
+    an->sample_rate = sample_rate;
+    an->fft_size = fft_size;
+    an->clip_threshold = clip_threshold;
+    an->edge_count = edge_count;
+    memcpy(an->edges, edges, edge_count * sizeof(double));
+    
+    fft_init(&an->fft, fft_size);
+    an->window = (double *)safe_emalloc(fft_size, sizeof(double), 0);
+    an->work = (double *)safe_emalloc(3 * fft_size + 2, sizeof(double), 0);
+    an->bin_band = (int *)safe_emalloc(fft_size / 2 + 1, sizeof(int), 0);
+    
+    for (int i = 0; i < fft_size; i++) {
+        an->window[i] = 0.5 - 0.5 * cos(2.0 * M_PI * i / fft_size);
+    }
+    
+    // Bin k fica na banda b se edges[b-1] <= f(k) < edges[b]
+    for (int k = 0, b = 0; k <= fft_size / 2; k++) {
+        double freq = (double)k * sample_rate / fft_size;
+        while (b < edge_count && freq >= edges[b]) b++;
+        an->bin_band[k] = b;
+    }
+    
+    analyzer_reset(an);
+}
+
+static void analyzer_stats(analyzer_object *an, zval *return_value)
+{
+    double total = 0.0;
+    zval bands;
+    
+    array_init(return_value);
+    add_assoc_long(return_value, "samples", an->samples);
+    add_assoc_double(return_value, "rms", an->samples ? sqrt((double)an->sum_sq / an->samples) : 0.0);
+    add_assoc_long(return_value, "peak", an->peak);
+    add_assoc_double(return_value, "dc", an->samples ? (double)an->sum / an->samples : 0.0);
+    add_assoc_double(return_value, "zcr", an->samples > 1 ? (double)an->crossings / (an->samples - 1) : 0.0);
+    add_assoc_long(return_value, "clipped", an->clipped);
+    
+    // Fração da energia espectral em cada banda delimitada pelas bordas
+    int band_count = an->edge_count ? an->edge_count + 1 : 0;
+    for (int b = 0; b < band_count; b++) {
+        total += an->band_energy[b];
+    }
+    array_init_size(&bands, (uint32_t)band_count);
+    for (int b = 0; b < band_count; b++) {
+        add_next_index_double(&bands, total > 0.0 ? an->band_energy[b] / total : 0.0);
+    }
+    add_assoc_zval(return_value, "bands", &bands);
+    add_assoc_long(return_value, "frames", an->frames);
+}
+
+// Busca ou cria o contexto para o par de taxas; src/dst <= 0 mantém o contexto atual
+static psampler_context *resampler_select_context(psampler_object *obj, zend_long src, zend_long dst)
+{
+    psampler_context *ctx = obj->current_context;
+    
+    if (src <= 0 || dst <= 0) {
+        return ctx;
+    }
+    
+    // Se as taxas fornecidas são as do contexto atual, não faz nada
+    if (ctx && (zend_long)ctx->src_rate == src && (zend_long)ctx->dst_rate == dst) {
+        return ctx;
+    }
+    
+    // Procura na lista de contextos
+    psampler_context *curr = obj->contexts;
+    psampler_context *prev = NULL;
+    while (curr) {
+        if ((zend_long)curr->src_rate == src && (zend_long)curr->dst_rate == dst) {
+            break;
+        }
+        prev = curr;
+        curr = curr->next;
+    }
+    
+    if (!curr) {
+        // Cria novo contexto e adiciona à lista
+        curr = create_context((double)src, (double)dst, obj->quality);
+        curr->silence_threshold = obj->silence_threshold;
+        if (prev) {
+            prev->next = curr;
+        } else {
+            obj->contexts = curr;
+        }
+    }
+    
+    obj->current_context = curr;
+    return curr;
+}
+
+// Garante espaço contíguo para mais `extra` amostras no fim da FIFO
+static int16_t *fifo_reserve(psampler_object *obj, size_t extra)
+{
+    if (obj->fifo_start + obj->fifo_used + extra > obj->fifo_size) {
+        // Compacta primeiro; só realoca se os dados ainda não couberem
+        if (obj->fifo_start > 0) {
+            memmove(obj->fifo, obj->fifo + obj->fifo_start, obj->fifo_used * sizeof(int16_t));
+            obj->fifo_start = 0;
+        }
+        if (obj->fifo_used + extra > obj->fifo_size) {
+            size_t size = obj->fifo_size ? obj->fifo_size : obj->frame_size * 4;
+            while (size < obj->fifo_used + extra) {
+                size *= 2;
+            }
+            obj->fifo = erealloc(obj->fifo, size * sizeof(int16_t));
+            obj->fifo_size = size;
+        }
+    }
+    return obj->fifo + obj->fifo_start + obj->fifo_used;
+}
+
+// Descarta o quadro do início da FIFO depois de copiado por pull()/pullInto()
+static void fifo_consume_frame(psampler_object *obj)
+{
+    obj->fifo_start += obj->frame_size;
+    obj->fifo_used -= obj->frame_size;
+    if (obj->fifo_used == 0) {
+        obj->fifo_start = 0;
+    }
+}
+
+// Destrutor para liberar memória
+static void psampler_free(zend_object *object)
+{
+    psampler_object *obj = (psampler_object *)((char *)object - XtOffsetOf(psampler_object, std));
+    
+    psampler_context *ctx = obj->contexts;
+    while (ctx) {
+        psampler_context *next = ctx->next;
+        free_context(ctx);
+        ctx = next;
+    }
+    
+    if (obj->fifo) {
+        efree(obj->fifo);
+    }
+    if (obj->analyzer) {
+        OBJ_RELEASE(obj->analyzer);
+    }
+    if (obj->fanout) {
+        free_fanout(obj->fanout);
+    }
+    
+    zend_object_std_dtor(&obj->std);
+}
+
+static zend_object_handlers psampler_handlers;
+
+static zend_object *psampler_create(zend_class_entry *ce)
+{
+    psampler_object *obj = zend_object_alloc(sizeof(psampler_object), ce);
+    zend_object_std_init(&obj->std, ce);
+    object_properties_init(&obj->std, ce);
+    obj->std.handlers = &psampler_handlers;
+    
+    // Inicializa ponteiros
+    obj->contexts = NULL;
+    obj->current_context = NULL;
+    obj->quality = PSAMPLER_QUALITY_DEFAULT;
+    obj->silence_threshold = 0;
+    obj->fifo = NULL;
+    obj->fifo_size = 0;
+    obj->fifo_start = 0;
+    obj->fifo_used = 0;
+    obj->frame_size = 0;
+    obj->analyzer = NULL;
+    obj->fanout = NULL;
+    
+    return &obj->std;
+}
+
+// Handlers para Analyzer
+static void analyzer_free(zend_object *object)
+{
+    analyzer_object *an = ANALYZER_FROM_OBJ(object);
+    analyzer_release_buffers(an);
+    zend_object_std_dtor(&an->std);
+}
+
+static zend_object_handlers analyzer_handlers;
+
+static zend_object *analyzer_create(zend_class_entry *ce)
+{
+    static const double default_edges[2] = {300.0, 3400.0};
+    analyzer_object *an = zend_object_alloc(sizeof(analyzer_object), ce);
+    zend_object_std_init(&an->std, ce);
+    object_properties_init(&an->std, ce);
+    an->std.handlers = &analyzer_handlers;
+    
+    // Configuração padrão: banda telefônica a 8 kHz
+    an->window = NULL;
+    analyzer_configure(an, 8000, 256, default_edges, 2, ANALYZER_DEFAULT_CLIP);
+    
+    return &an->std;
+}
+
+// Handlers para LPCM
+static void lpcm_free(zend_object *object)
+{
+    lpcm_object *obj = (lpcm_object *)((char *)object - XtOffsetOf(lpcm_object, std));
+    zend_object_std_dtor(&obj->std);
+}
+
+static zend_object_handlers lpcm_handlers;
+
+static zend_object *lpcm_create(zend_class_entry *ce)
+{
+    lpcm_object *obj = zend_object_alloc(sizeof(lpcm_object), ce);
+    zend_object_std_init(&obj->std, ce);
+    object_properties_init(&obj->std, ce);
+    obj->std.handlers = &lpcm_handlers;
+    
+    // Valores padrão
+    obj->channels = 1;
+    obj->bit_depth = 16;
+    obj->is_big_endian = 0;
+    
+    return &obj->std;
+}
+
+PHP_METHOD(Resampler, __construct)
+{
+    zend_long src = 0, dst = 0, quality = PSAMPLER_QUALITY_DEFAULT;
+    ZEND_PARSE_PARAMETERS_START(0, 3)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(src)
+        Z_PARAM_LONG(dst)
+        Z_PARAM_LONG(quality)
+    ZEND_PARSE_PARAMETERS_END();
+
+    // Valida o preset de qualidade
+    if (quality < PSAMPLER_QUALITY_DEFAULT || quality > PSAMPLER_QUALITY_OFFLINE) {
+        zend_throw_exception(NULL, "Quality must be QUALITY_DEFAULT, QUALITY_HIGH or QUALITY_OFFLINE", 0);
+        RETURN_THROWS();
+    }
+
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    obj->pending_samples = 0;
+    obj->min_output_samples = 512; // Mínimo de amostras para pacote válido
+    obj->quality = (int)quality;
+    
+    // Se as taxas forem fornecidas, cria o primeiro contexto
+    if (src > 0 && dst > 0) {
+        psampler_context *ctx = create_context((double)src, (double)dst, obj->quality);
+        obj->contexts = ctx;
+        obj->current_context = ctx;
+    }
+}
+
+PHP_METHOD(Resampler, reset)
+{
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    
+    // O usuário solicitou que reset() limpe os contextos/estados
+    psampler_context *ctx = obj->contexts;
+    while (ctx) {
+        psampler_context *next = ctx->next;
+        free_context(ctx);
+        ctx = next;
+    }
+    
+    obj->contexts = NULL;
+    obj->current_context = NULL;
+    obj->pending_samples = 0;
+    obj->fifo_start = 0;
+    obj->fifo_used = 0;
+    
+    if (obj->fanout) {
+        free_fanout(obj->fanout);
+        obj->fanout = NULL;
+    }
+    
+    RETURN_TRUE;
+}
+
+PHP_METHOD(Resampler, returnEmpty)
+{
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    
+    // No modo framed, o pacote válido é um quadro completo na FIFO
+    if (obj->frame_size > 0) {
+        if (obj->fifo_used >= obj->frame_size) {
+            RETURN_FALSE;
+        }
+        RETURN_EMPTY_STRING();
+    }
+    
+    // Verifica se há amostras pendentes suficientes para um pacote válido
+    if (obj->pending_samples >= obj->min_output_samples) {
+        obj->pending_samples = 0;
+        RETURN_FALSE; // Retorna false indicando que há pacote válido disponível
+    }
+    
+    // Retorna string vazia (pacote vazio) enquanto não há amostras suficientes
+    RETURN_EMPTY_STRING();
+}
+
+PHP_METHOD(Resampler, sample)
+{
+    zend_string *input;
+    zend_long src = 0, dst = 0;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 3)
+        Z_PARAM_STR(input)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(src)
+        Z_PARAM_LONG(dst)
+    ZEND_PARSE_PARAMETERS_END();
+
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    psampler_context *ctx = resampler_select_context(obj, src, dst);
+    
+    // Verifica se temos um contexto válido
+    if (!ctx) {
+        php_error_docref(NULL, E_WARNING, "Resampler not initialized with valid sample rates.");
+        RETURN_EMPTY_STRING();
+    }
+
+    const int16_t *new_samples = (const int16_t *)ZSTR_VAL(input);
+    size_t new_count = ZSTR_LEN(input) / 2;
+    
+    if (new_count == 0) {
+        RETURN_EMPTY_STRING();
+    }
+    
+    zend_string *out = zend_string_alloc(context_output_bound(ctx, new_count) * sizeof(int16_t), 0);
+    size_t out_count = context_process(ctx, new_samples, new_count, (int16_t *)ZSTR_VAL(out));
+    
+    // Atualiza pending_samples para controle de returnEmpty()
     obj->pending_samples = (int)out_count;
     
-    // Remove amostras processadas do buffer
-    size_t consumed = (size_t)ctx->frac_pos;
-    if (consumed > 0 && consumed < ctx->buffer_used) {
-        ctx->frac_pos -= consumed;
-        memmove(ctx->input_buffer, ctx->input_buffer + consumed, 
-                (ctx->buffer_used - consumed) * sizeof(int16_t));
-        ctx->buffer_used -= consumed;
-    } else if (consumed >= ctx->buffer_used) {
-        ctx->buffer_used = 0;
-        ctx->frac_pos = 0.0;
+    // Analisa a saída enquanto ela ainda está no cache
+    if (obj->analyzer && out_count > 0) {
+        analyzer_update(ANALYZER_FROM_OBJ(obj->analyzer), (const int16_t *)ZSTR_VAL(out), out_count);
+    }
+    
+    if (out_count == 0) {
+        zend_string_efree(out);
+        RETURN_EMPTY_STRING();
+    }
+    
+    out = zend_string_truncate(out, out_count * sizeof(int16_t), 0);
+    ZSTR_VAL(out)[ZSTR_LEN(out)] = '\0';
+    RETURN_NEW_STR(out);
+}
+
+PHP_METHOD(Resampler, flush)
+{
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    psampler_context *ctx = obj->current_context;
+    zend_string *out = NULL;
+    
+    // Só os presets HIGH/OFFLINE retêm entrada além de poucas amostras
+    if (!ctx || (!ctx->ols && !ctx->longfir)) {
+        RETURN_EMPTY_STRING();
+    }
+    
+    // Completa a entrada com zeros até sair a cauda inteira, compensada pelo atraso de grupo
+    size_t pending = long_filter_pending(ctx);
+    if (pending > 0) {
+        size_t slack = ctx->ols ? (size_t)(ctx->ols->block / ctx->ols->decim + 1) : 0;
+        out = zend_string_alloc((pending + slack) * sizeof(int16_t), 0);
+        if (ctx->ols) {
+            ols_flush(ctx, pending, (int16_t *)ZSTR_VAL(out));
+        } else {
+            longfir_flush(ctx, pending, (int16_t *)ZSTR_VAL(out));
+        }
+        
+        if (obj->analyzer) {
+            analyzer_update(ANALYZER_FROM_OBJ(obj->analyzer), (const int16_t *)ZSTR_VAL(out), pending);
+        }
+    }
+    
+    // O próximo sample() começa um fluxo novo
+    long_filter_restart(ctx);
+    
+    if (!out) {
+        RETURN_EMPTY_STRING();
+    }
+    out = zend_string_truncate(out, pending * sizeof(int16_t), 0);
+    ZSTR_VAL(out)[ZSTR_LEN(out)] = '\0';
+    RETURN_NEW_STR(out);
+}
+
+PHP_METHOD(Resampler, setFrameSize)
+{
+    zend_long frame_size;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(frame_size)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    if (frame_size < 0 || frame_size > MAX_BUFFER_SIZE) {
+        zend_throw_exception(NULL, "Frame size must be between 0 and 8192 samples", 0);
+        RETURN_THROWS();
+    }
+    
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    obj->frame_size = (size_t)frame_size;
+    
+    // Tamanho 0 desliga o modo framed e descarta a FIFO
+    if (frame_size == 0) {
+        if (obj->fifo) {
+            efree(obj->fifo);
+        }
+        obj->fifo = NULL;
+        obj->fifo_size = 0;
+        obj->fifo_start = 0;
+        obj->fifo_used = 0;
+    }
+    
+    RETURN_TRUE;
+}
+
+PHP_METHOD(Resampler, push)
+{
+    zend_string *input;
+    zend_long src = 0, dst = 0;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 3)
+        Z_PARAM_STR(input)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(src)
+        Z_PARAM_LONG(dst)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    
+    if (obj->frame_size == 0) {
+        zend_throw_exception(NULL, "Framed mode is disabled, call setFrameSize() first", 0);
+        RETURN_THROWS();
+    }
+    
+    psampler_context *ctx = resampler_select_context(obj, src, dst);
+    if (!ctx) {
+        php_error_docref(NULL, E_WARNING, "Resampler not initialized with valid sample rates.");
+        RETURN_LONG(0);
+    }
+    
+    size_t new_count = ZSTR_LEN(input) / 2;
+    if (new_count > 0) {
+        // Resampleia direto para o fim da FIFO, sem string intermediária
+        int16_t *tail = fifo_reserve(obj, context_output_bound(ctx, new_count));
+        size_t out_count = context_process(ctx, (const int16_t *)ZSTR_VAL(input), new_count, tail);
+        obj->fifo_used += out_count;
+        obj->pending_samples = (int)out_count;
+        
+        if (obj->analyzer && out_count > 0) {
+            analyzer_update(ANALYZER_FROM_OBJ(obj->analyzer), tail, out_count);
+        }
+    }
+    
+    RETURN_LONG((zend_long)(obj->fifo_used / obj->frame_size));
+}
+
+PHP_METHOD(Resampler, pull)
+{
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    
+    if (obj->frame_size == 0 || obj->fifo_used < obj->frame_size) {
+        RETURN_FALSE;
+    }
+    
+    // Cada quadro é uma string nova: o chamador pode guardá-la sem que o próximo pull() a altere
+    zend_string *frame = zend_string_init((const char *)(obj->fifo + obj->fifo_start),
+                                          obj->frame_size * sizeof(int16_t), 0);
+    fifo_consume_frame(obj);
+    
+    RETURN_NEW_STR(frame);
+}
+
+PHP_METHOD(Resampler, pullInto)
+{
+    zval *target;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_ZVAL(target)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    
+    if (obj->frame_size == 0 || obj->fifo_used < obj->frame_size) {
+        RETURN_FALSE;
+    }
+    
+    const char *frame = (const char *)(obj->fifo + obj->fifo_start);
+    size_t bytes = obj->frame_size * sizeof(int16_t);
+    zval *value = Z_REFVAL_P(target);
+    
+    // Reescreve a string do chamador no lugar quando só ele a referencia e ela já tem o tamanho
+    // do quadro; se foi guardada em outro lugar, aloca uma nova e a cópia retida fica intacta
+    if (Z_TYPE_P(value) == IS_STRING && !ZSTR_IS_INTERNED(Z_STR_P(value))
+        && GC_REFCOUNT(Z_STR_P(value)) == 1 && Z_STRLEN_P(value) == bytes) {
+        memcpy(Z_STRVAL_P(value), frame, bytes);
+        zend_string_forget_hash_val(Z_STR_P(value));
+    } else {
+        ZEND_TRY_ASSIGN_REF_STRINGL(target, frame, bytes);
+        if (EG(exception)) {
+            RETURN_THROWS();
+        }
+    }
+    fifo_consume_frame(obj);
+    
+    RETURN_TRUE;
+}
+
+PHP_METHOD(Resampler, fanout)
+{
+    zend_string *input;
+    zend_long src;
+    HashTable *rates_ht;
+    zend_long rates[FANOUT_MAX_RATES];
+    int count = 0;
+    zval *entry;
+    
+    ZEND_PARSE_PARAMETERS_START(3, 3)
+        Z_PARAM_STR(input)
+        Z_PARAM_LONG(src)
+        Z_PARAM_ARRAY_HT(rates_ht)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    if (src <= 0) {
+        zend_throw_exception(NULL, "Source rate must be positive", 0);
+        RETURN_THROWS();
+    }
+    
+    uint32_t rate_count = zend_hash_num_elements(rates_ht);
+    if (rate_count == 0 || rate_count > FANOUT_MAX_RATES) {
+        zend_throw_exception(NULL, "Fan-out needs between 1 and 8 destination rates", 0);
+        RETURN_THROWS();
+    }
+    
+    ZEND_HASH_FOREACH_VAL(rates_ht, entry) {
+        zend_long rate = zval_get_long(entry);
+        if (rate <= 0) {
+            zend_throw_exception(NULL, "Destination rates must be positive", 0);
+            RETURN_THROWS();
+        }
+        for (int b = 0; b < count; b++) {
+            if (rates[b] == rate) {
+                zend_throw_exception(NULL, "Destination rates must be unique", 0);
+                RETURN_THROWS();
+            }
+        }
+        rates[count++] = rate;
+    } ZEND_HASH_FOREACH_END();
+    
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    
+    // Outra taxa de entrada ou outro conjunto de saídas recomeça o grupo
+    if (obj->fanout && !fanout_matches(obj->fanout, src, rates, count)) {
+        free_fanout(obj->fanout);
+        obj->fanout = NULL;
+    }
+    if (!obj->fanout) {
+        obj->fanout = create_fanout(src, rates, count, obj->silence_threshold);
+    }
+    
+    // O Analyzer mede um único fluxo e o fan-out gera um por taxa; o preset longo não se aplica
+    if (obj->analyzer) {
+        php_error_docref(NULL, E_WARNING, "fanout() output is not passed to the attached Analyzer");
+    }
+    if (obj->quality != PSAMPLER_QUALITY_DEFAULT) {
+        php_error_docref(NULL, E_WARNING, "fanout() always uses the default 64-tap filter; the quality preset is ignored");
+    }
+    
+    psampler_fanout *fan = obj->fanout;
+    size_t new_count = ZSTR_LEN(input) / 2;
+    zend_string *outs[FANOUT_MAX_RATES];
+    int16_t *out_ptrs[FANOUT_MAX_RATES];
+    size_t out_counts[FANOUT_MAX_RATES];
+    
+    for (int b = 0; b < count; b++) {
+        outs[b] = zend_string_alloc(fanout_output_bound(fan, b, new_count) * sizeof(int16_t), 0);
+        out_ptrs[b] = (int16_t *)ZSTR_VAL(outs[b]);
+    }
+    
+    fanout_process(fan, (const int16_t *)ZSTR_VAL(input), new_count, out_ptrs, out_counts);
+    
+    array_init_size(return_value, (uint32_t)count);
+    for (int b = 0; b < count; b++) {
+        if (out_counts[b] == 0) {
+            zend_string_efree(outs[b]);
+            add_index_str(return_value, rates[b], ZSTR_EMPTY_ALLOC());
+            continue;
+        }
+        outs[b] = zend_string_truncate(outs[b], out_counts[b] * sizeof(int16_t), 0);
+        ZSTR_VAL(outs[b])[ZSTR_LEN(outs[b])] = '\0';
+        add_index_str(return_value, rates[b], outs[b]);
+    }
+}
+
+PHP_METHOD(Resampler, setAnalyzer)
+{
+    zval *analyzer = NULL;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_OBJECT_OF_CLASS_OR_NULL(analyzer, analyzer_ce)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    
+    if (obj->analyzer) {
+        OBJ_RELEASE(obj->analyzer);
+        obj->analyzer = NULL;
+    }
+    
+    // Mantém uma referência própria; null desliga a análise
+    if (analyzer) {
+        obj->analyzer = Z_OBJ_P(analyzer);
+        GC_ADDREF(obj->analyzer);
+    }
+    
+    RETURN_TRUE;
+}
+
+PHP_METHOD(Resampler, setSilenceThreshold)
+{
+    zend_long threshold;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_LONG(threshold)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    if (threshold < -1 || threshold > 32767) {
+        zend_throw_exception(NULL, "Silence threshold must be between -1 and 32767", 0);
+        RETURN_THROWS();
+    }
+    
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    obj->silence_threshold = (int)threshold;
+    
+    for (psampler_context *ctx = obj->contexts; ctx; ctx = ctx->next) {
+        ctx->silence_threshold = (int)threshold;
+    }
+    if (obj->fanout) {
+        obj->fanout->silence_threshold = (int)threshold;
+    }
+    
+    RETURN_TRUE;
+}
+
+PHP_METHOD(Resampler, getSilentSamples)
+{
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    zend_long total = 0;
+    
+    for (psampler_context *ctx = obj->contexts; ctx; ctx = ctx->next) {
+        total += ctx->silent_samples;
+    }
+    if (obj->fanout) {
+        total += obj->fanout->silent_samples;
+    }
+    
+    RETURN_LONG(total);
+}
+
+PHP_METHOD(Resampler, process)
+{
+    // Alias para manter compatibilidade, chama sample internamente sem trocar taxas
+    zend_string *input;
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(input)
+    ZEND_PARSE_PARAMETERS_END();
+
+    psampler_object *obj = PSAMPLER_OBJ(getThis());
+    psampler_context *ctx = obj->current_context;
+    
+    if (!ctx) {
+        php_error_docref(NULL, E_WARNING, "Resampler not initialized with valid sample rates.");
+        RETURN_EMPTY_STRING();
+    }
+
+    // Chama sample internamente com as taxas do contexto atual
+    zval method_name, params[3];
+    ZVAL_STRING(&method_name, "sample");
+    ZVAL_STR(&params[0], input);
+    ZVAL_LONG(&params[1], (zend_long)ctx->src_rate);
+    ZVAL_LONG(&params[2], (zend_long)ctx->dst_rate);
+
+    call_user_function(NULL, getThis(), &method_name, return_value, 3, params);
+    
+    zval_ptr_dtor(&method_name);
+}
+
+// ============================================================================
+// Métodos da classe LPCM
+// ============================================================================
+
+PHP_METHOD(LPCM, __construct)
+{
+    zend_long channels, bit_depth;
+    zend_bool is_big_endian = 0;
+    
+    ZEND_PARSE_PARAMETERS_START(2, 3)
+        Z_PARAM_LONG(channels)
+        Z_PARAM_LONG(bit_depth)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_BOOL(is_big_endian)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    lpcm_object *obj = LPCM_OBJ(getThis());
+    
+    // Valida channels
+    if (channels < 1 || channels > LPCM_MAX_CHANNELS) {
+        zend_throw_exception(NULL, "Channels must be between 1 and 32", 0);
+        RETURN_THROWS();
+    }
+    
+    // Valida bit_depth
+    if (bit_depth != 8 && bit_depth != 16 && bit_depth != 24 && bit_depth != 32) {
+        zend_throw_exception(NULL, "Bit depth must be 8, 16, 24, or 32", 0);
+        RETURN_THROWS();
+    }
+    
+    obj->channels = (int)channels;
+    obj->bit_depth = (int)bit_depth;
+    obj->is_big_endian = is_big_endian ? 1 : 0;
+}
+
+PHP_METHOD(LPCM, encodeMono)
+{
+    zval *samples_array;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_ARRAY(samples_array)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    lpcm_object *obj = LPCM_OBJ(getThis());
+    
+    if (obj->channels != 1) {
+        zend_throw_exception(NULL, "encodeMono requires channels=1", 0);
+        RETURN_THROWS();
+    }
+    
+    HashTable *ht = Z_ARRVAL_P(samples_array);
+    size_t num_samples = zend_hash_num_elements(ht);
+    
+    if (num_samples == 0) {
+        RETURN_EMPTY_STRING();
+    }
+    
+    smart_str out = {0};
+    int bytes_per_sample = obj->bit_depth / 8;
+    
+    zval *entry;
+    ZEND_HASH_FOREACH_VAL(ht, entry) {
+        int32_t sample = (int32_t)zval_get_long(entry);
+        
+        // Clipping baseado no bit depth (usa int64_t para evitar overflow em 32-bit)
+        int64_t max_val = ((int64_t)1 << (obj->bit_depth - 1)) - 1;
+        int64_t min_val = -((int64_t)1 << (obj->bit_depth - 1));
+        if (sample > max_val) sample = (int32_t)max_val;
+        if (sample < min_val) sample = (int32_t)min_val;
+        
+        // Escreve bytes conforme endianness
+        unsigned char bytes[4];
+        for (int i = 0; i < bytes_per_sample; i++) {
+            if (obj->is_big_endian) {
+                bytes[i] = (sample >> ((bytes_per_sample - 1 - i) * 8)) & 0xFF;
+            } else {
+                bytes[i] = (sample >> (i * 8)) & 0xFF;
+            }
+        }
+        smart_str_appendl(&out, (char *)bytes, bytes_per_sample);
+    } ZEND_HASH_FOREACH_END();
+    
+    smart_str_0(&out);
+    RETURN_STR(out.s);
+}
+
+PHP_METHOD(LPCM, decodeMono)
+{
+    char *pcm_data;
+    size_t pcm_len;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STRING(pcm_data, pcm_len)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    lpcm_object *obj = LPCM_OBJ(getThis());
+    
+    if (obj->channels != 1) {
+        zend_throw_exception(NULL, "decodeMono requires channels=1", 0);
+        RETURN_THROWS();
+    }
+    
+    int bytes_per_sample = obj->bit_depth / 8;
+    size_t num_samples = pcm_len / bytes_per_sample;
+    
+    array_init(return_value);
+    
+    for (size_t i = 0; i < num_samples; i++) {
+        unsigned char *bytes = (unsigned char *)&pcm_data[i * bytes_per_sample];
+        int32_t sample = 0;
+        
+        // Lê bytes conforme endianness
+        for (int j = 0; j < bytes_per_sample; j++) {
+            if (obj->is_big_endian) {
+                sample |= ((int32_t)bytes[j]) << ((bytes_per_sample - 1 - j) * 8);
+            } else {
+                sample |= ((int32_t)bytes[j]) << (j * 8);
+            }
+        }
+        
+        // Extensão de sinal para valores negativos (usa int64_t para evitar overflow em 32-bit)
+        if (sample & ((int64_t)1 << (obj->bit_depth - 1))) {
+            sample |= ~(((int64_t)1 << obj->bit_depth) - 1);
+        }
+        
+        add_next_index_long(return_value, sample);
+    }
+}
+
+PHP_METHOD(LPCM, encodeStereo)
+{
+    zval *left_array, *right_array;
+    
+    ZEND_PARSE_PARAMETERS_START(2, 2)
+        Z_PARAM_ARRAY(left_array)
+        Z_PARAM_ARRAY(right_array)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    lpcm_object *obj = LPCM_OBJ(getThis());
+    
+    if (obj->channels != 2) {
+        zend_throw_exception(NULL, "encodeStereo requires channels=2", 0);
+        RETURN_THROWS();
+    }
+    
+    HashTable *left_ht = Z_ARRVAL_P(left_array);
+    HashTable *right_ht = Z_ARRVAL_P(right_array);
+    size_t left_count = zend_hash_num_elements(left_ht);
+    size_t right_count = zend_hash_num_elements(right_ht);
+    
+    if (left_count != right_count) {
+        zend_throw_exception(NULL, "Left and right arrays must have same length", 0);
+        RETURN_THROWS();
+    }
+    
+    if (left_count == 0) {
+        RETURN_EMPTY_STRING();
     }
     
-    smart_str_0(&out);
+    smart_str out = {0};
+    int bytes_per_sample = obj->bit_depth / 8;
+    
+    zval *left_entry, *right_entry;
+    HashPosition left_pos, right_pos;
+    
+    zend_hash_internal_pointer_reset_ex(left_ht, &left_pos);
+    zend_hash_internal_pointer_reset_ex(right_ht, &right_pos);
     
-    if (out_count == 0) {
-        smart_str_free(&out);
-        RETURN_EMPTY_STRING();
+    for (size_t i = 0; i < left_count; i++) {
+        left_entry = zend_hash_get_current_data_ex(left_ht, &left_pos);
+        right_entry = zend_hash_get_current_data_ex(right_ht, &right_pos);
+        
+        int32_t samples[2] = {
+            (int32_t)zval_get_long(left_entry),
+            (int32_t)zval_get_long(right_entry)
+        };
+        
+        for (int ch = 0; ch < 2; ch++) {
+            int32_t sample = samples[ch];
+            
+            // Clipping (usa int64_t para evitar overflow em 32-bit)
+            int64_t max_val = ((int64_t)1 << (obj->bit_depth - 1)) - 1;
+            int64_t min_val = -((int64_t)1 << (obj->bit_depth - 1));
+            if (sample > max_val) sample = (int32_t)max_val;
+            if (sample < min_val) sample = (int32_t)min_val;
+            
+            // Escreve bytes
+            unsigned char bytes[4];
+            for (int j = 0; j < bytes_per_sample; j++) {
+                if (obj->is_big_endian) {
+                    bytes[j] = (sample >> ((bytes_per_sample - 1 - j) * 8)) & 0xFF;
+                } else {
+                    bytes[j] = (sample >> (j * 8)) & 0xFF;
+                }
+            }
+            smart_str_appendl(&out, (char *)bytes, bytes_per_sample);
+        }
+        
+        zend_hash_move_forward_ex(left_ht, &left_pos);
+        zend_hash_move_forward_ex(right_ht, &right_pos);
     }
     
+    smart_str_0(&out);
     RETURN_STR(out.s);
 }
 
-PHP_METHOD(Resampler, process)
+PHP_METHOD(LPCM, decodeStereo)
 {
-    // Alias para manter compatibilidade, chama sample internamente sem trocar taxas
-    zend_string *input;
+    char *pcm_data;
+    size_t pcm_len;
+    
     ZEND_PARSE_PARAMETERS_START(1, 1)
-        Z_PARAM_STR(input)
+        Z_PARAM_STRING(pcm_data, pcm_len)
     ZEND_PARSE_PARAMETERS_END();
+    
+    lpcm_object *obj = LPCM_OBJ(getThis());
+    
+    if (obj->channels != 2) {
+        zend_throw_exception(NULL, "decodeStereo requires channels=2", 0);
+        RETURN_THROWS();
+    }
+    
+    int bytes_per_sample = obj->bit_depth / 8;
+    size_t num_frames = pcm_len / (bytes_per_sample * 2);
+    
+    zval left_array, right_array;
+    array_init(&left_array);
+    array_init(&right_array);
+    
+    for (size_t i = 0; i < num_frames; i++) {
+        for (int ch = 0; ch < 2; ch++) {
+            unsigned char *bytes = (unsigned char *)&pcm_data[(i * 2 + ch) * bytes_per_sample];
+            int32_t sample = 0;
+            
+            // Lê bytes
+            for (int j = 0; j < bytes_per_sample; j++) {
+                if (obj->is_big_endian) {
+                    sample |= ((int32_t)bytes[j]) << ((bytes_per_sample - 1 - j) * 8);
+                } else {
+                    sample |= ((int32_t)bytes[j]) << (j * 8);
+                }
+            }
+            
+            // Extensão de sinal (usa int64_t para evitar overflow em 32-bit)
+            if (sample & ((int64_t)1 << (obj->bit_depth - 1))) {
+                sample |= ~(((int64_t)1 << obj->bit_depth) - 1);
+            }
+            
+            if (ch == 0) {
+                add_next_index_long(&left_array, sample);
+            } else {
+                add_next_index_long(&right_array, sample);
+            }
+        }
+    }
+    
+    array_init(return_value);
+    add_next_index_zval(return_value, &left_array);
+    add_next_index_zval(return_value, &right_array);
+}
 
-    psampler_object *obj = PSAMPLER_OBJ(getThis());
-    psampler_context *ctx = obj->current_context;
+// ============================================================================
+// Operações de layout de canais sobre LPCM empacotado
+// ============================================================================
+
+// Lê uma amostra com extensão de sinal
+static inline int32_t lpcm_read_sample(const unsigned char *bytes, int bit_depth, int is_big_endian)
+{
+    int bytes_per_sample = bit_depth / 8;
+    uint32_t value = 0;
     
-    if (!ctx) {
-        php_error_docref(NULL, E_WARNING, "Resampler not initialized with valid sample rates.");
-        RETURN_EMPTY_STRING();
+    for (int j = 0; j < bytes_per_sample; j++) {
+        int shift = is_big_endian ? (bytes_per_sample - 1 - j) * 8 : j * 8;
+        value |= ((uint32_t)bytes[j]) << shift;
     }
+    if (bit_depth < 32 && (value & ((uint32_t)1 << (bit_depth - 1)))) {
+        value |= ~(((uint32_t)1 << bit_depth) - 1);
+    }
+    return (int32_t)value;
+}
 
-    // Chama sample internamente com as taxas do contexto atual
-    zval method_name, params[3];
-    ZVAL_STRING(&method_name, "sample");
-    ZVAL_STR(&params[0], input);
-    ZVAL_LONG(&params[1], (zend_long)ctx->src_rate);
-    ZVAL_LONG(&params[2], (zend_long)ctx->dst_rate);
+static inline void lpcm_write_sample(unsigned char *bytes, int64_t sample, int bit_depth, int is_big_endian)
+{
+    int bytes_per_sample = bit_depth / 8;
+    int64_t max_val = ((int64_t)1 << (bit_depth - 1)) - 1;
+    int64_t min_val = -((int64_t)1 << (bit_depth - 1));
+    
+    if (sample > max_val) sample = max_val;
+    if (sample < min_val) sample = min_val;
+    
+    for (int j = 0; j < bytes_per_sample; j++) {
+        int shift = is_big_endian ? (bytes_per_sample - 1 - j) * 8 : j * 8;
+        bytes[j] = (unsigned char)((sample >> shift) & 0xFF);
+    }
+}
 
-    call_user_function(NULL, getThis(), &method_name, return_value, 3, params);
+// Stereo 16-bit: separa L/R. Cada quadro L/R vira uma lane de 32 bits e os
+// shifts aritméticos extraem cada metade já com sinal.
+static void deinterleave2_s16(const int16_t *in, int16_t *left, int16_t *right, size_t frames)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 8 <= frames; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(in + 2 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(in + 2 * i + 8));
+        if (left) {
+            __m128i la = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+            __m128i lb = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+            _mm_storeu_si128((__m128i *)(left + i), _mm_packs_epi32(la, lb));
+        }
+        if (right) {
+            __m128i ra = _mm_srai_epi32(a, 16);
+            __m128i rb = _mm_srai_epi32(b, 16);
+            _mm_storeu_si128((__m128i *)(right + i), _mm_packs_epi32(ra, rb));
+        }
+    }
+#endif
+    for (; i < frames; i++) {
+        if (left) left[i] = in[2 * i];
+        if (right) right[i] = in[2 * i + 1];
+    }
+}
+
+static void interleave2_s16(const int16_t *left, const int16_t *right, int16_t *out, size_t frames)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + 8 <= frames; i += 8) {
+        __m128i l = _mm_loadu_si128((const __m128i *)(left + i));
+        __m128i r = _mm_loadu_si128((const __m128i *)(right + i));
+        _mm_storeu_si128((__m128i *)(out + 2 * i), _mm_unpacklo_epi16(l, r));
+        _mm_storeu_si128((__m128i *)(out + 2 * i + 8), _mm_unpackhi_epi16(l, r));
+    }
+#endif
+    for (; i < frames; i++) {
+        out[2 * i] = left[i];
+        out[2 * i + 1] = right[i];
+    }
+}
+
+// Substitui um canal de um stream stereo 16-bit, preservando o outro
+static void insert2_s16(int16_t *stereo, const int16_t *mono, int channel, size_t frames)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128i keep = channel ? _mm_set1_epi32(0x0000FFFF) : _mm_set1_epi32((int)0xFFFF0000);
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= frames; i += 8) {
+        __m128i m = _mm_loadu_si128((const __m128i *)(mono + i));
+        __m128i lo = channel ? _mm_unpacklo_epi16(zero, m) : _mm_unpacklo_epi16(m, zero);
+        __m128i hi = channel ? _mm_unpackhi_epi16(zero, m) : _mm_unpackhi_epi16(m, zero);
+        __m128i a = _mm_loadu_si128((const __m128i *)(stereo + 2 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(stereo + 2 * i + 8));
+        _mm_storeu_si128((__m128i *)(stereo + 2 * i), _mm_or_si128(_mm_and_si128(a, keep), lo));
+        _mm_storeu_si128((__m128i *)(stereo + 2 * i + 8), _mm_or_si128(_mm_and_si128(b, keep), hi));
+    }
+#endif
+    for (; i < frames; i++) {
+        stereo[2 * i + channel] = mono[i];
+    }
+}
+
+// Mixagem stereo -> mono 16-bit com pesos, arredondamento e saturação
+static void downmix2_s16(const int16_t *in, int16_t *out, size_t frames, float left_weight, float right_weight)
+{
+    size_t i = 0;
+#ifdef __SSE2__
+    __m128 wl = _mm_set1_ps(left_weight);
+    __m128 wr = _mm_set1_ps(right_weight);
+    // Satura em float: fora de int32 o cvtps devolve 0x80000000, que o pack viraria -32768
+    __m128 hi = _mm_set1_ps(32767.0f);
+    __m128 lo = _mm_set1_ps(-32768.0f);
+    for (; i + 8 <= frames; i += 8) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(in + 2 * i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(in + 2 * i + 8));
+        __m128 la = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16));
+        __m128 lb = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+        __m128 ra = _mm_cvtepi32_ps(_mm_srai_epi32(a, 16));
+        __m128 rb = _mm_cvtepi32_ps(_mm_srai_epi32(b, 16));
+        __m128 fa = _mm_add_ps(_mm_mul_ps(la, wl), _mm_mul_ps(ra, wr));
+        __m128 fb = _mm_add_ps(_mm_mul_ps(lb, wl), _mm_mul_ps(rb, wr));
+        __m128i ma = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(fa, hi), lo));
+        __m128i mb = _mm_cvtps_epi32(_mm_max_ps(_mm_min_ps(fb, hi), lo));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_packs_epi32(ma, mb));
+    }
+#endif
+    for (; i < frames; i++) {
+        float mixed = (float)in[2 * i] * left_weight + (float)in[2 * i + 1] * right_weight;
+        if (mixed > 32767.0f) mixed = 32767.0f;
+        else if (mixed < -32768.0f) mixed = -32768.0f;
+        out[i] = (int16_t)lrintf(mixed);
+    }
+}
+
+// Copia o canal `channel` de um stream com `channels` canais (qualquer bit depth)
+static void extract_channel_bytes(const char *in, char *out, size_t frames, int channels, int channel, int bytes_per_sample)
+{
+    size_t stride = (size_t)channels * bytes_per_sample;
+    const char *src = in + (size_t)channel * bytes_per_sample;
     
-    zval_ptr_dtor(&method_name);
+    for (size_t i = 0; i < frames; i++) {
+        memcpy(out + i * bytes_per_sample, src + i * stride, bytes_per_sample);
+    }
 }
 
-// ============================================================================
-// Métodos da classe LPCM
-// ============================================================================
+static void insert_channel_bytes(char *inout, const char *mono, size_t frames, int channels, int channel, int bytes_per_sample)
+{
+    size_t stride = (size_t)channels * bytes_per_sample;
+    char *dst = inout + (size_t)channel * bytes_per_sample;
+    
+    for (size_t i = 0; i < frames; i++) {
+        memcpy(dst + i * stride, mono + i * bytes_per_sample, bytes_per_sample);
+    }
+}
 
-PHP_METHOD(LPCM, __construct)
+static zend_string *lpcm_alloc_result(size_t len)
 {
-    zend_long channels, bit_depth;
-    zend_bool is_big_endian = 0;
+    zend_string *result = zend_string_alloc(len, 0);
+    ZSTR_VAL(result)[len] = '\0';
+    return result;
+}
+
+// Canais do stream intercalado: os do objeto; um valor explícito precisa coincidir com eles
+static int lpcm_stream_channels(lpcm_object *obj, const char *method, zend_long channels, zend_bool channels_is_null)
+{
+    if (!channels_is_null && channels != obj->channels) {
+        zend_throw_exception_ex(NULL, 0, "%s requires channels=%d", method, obj->channels);
+        return 0;
+    }
+    return obj->channels;
+}
+
+PHP_METHOD(LPCM, downmix)
+{
+    char *pcm_data;
+    size_t pcm_len;
+    double left_weight = 0.5, right_weight = 0.5;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 3)
+        Z_PARAM_STRING(pcm_data, pcm_len)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_DOUBLE(left_weight)
+        Z_PARAM_DOUBLE(right_weight)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    lpcm_object *obj = LPCM_OBJ(getThis());
+    
+    if (obj->channels != 2) {
+        zend_throw_exception(NULL, "downmix requires channels=2", 0);
+        RETURN_THROWS();
+    }
+    
+    int bytes_per_sample = obj->bit_depth / 8;
+    size_t frames = pcm_len / (bytes_per_sample * 2);
+    
+    if (frames == 0) {
+        RETURN_EMPTY_STRING();
+    }
+    
+    zend_string *result = lpcm_alloc_result(frames * bytes_per_sample);
+    
+    if (obj->bit_depth == 16 && !obj->is_big_endian) {
+        downmix2_s16((const int16_t *)pcm_data, (int16_t *)ZSTR_VAL(result), frames,
+                     (float)left_weight, (float)right_weight);
+    } else {
+        const unsigned char *in = (const unsigned char *)pcm_data;
+        unsigned char *out = (unsigned char *)ZSTR_VAL(result);
+        for (size_t i = 0; i < frames; i++) {
+            double left = lpcm_read_sample(in + (2 * i) * bytes_per_sample, obj->bit_depth, obj->is_big_endian);
+            double right = lpcm_read_sample(in + (2 * i + 1) * bytes_per_sample, obj->bit_depth, obj->is_big_endian);
+            double mixed = left * left_weight + right * right_weight;
+            // llrint fora de int64 é indefinido; lpcm_write_sample satura no bit depth
+            if (mixed > 2147483647.0) mixed = 2147483647.0;
+            else if (mixed < -2147483648.0) mixed = -2147483648.0;
+            lpcm_write_sample(out + i * bytes_per_sample, llrint(mixed), obj->bit_depth, obj->is_big_endian);
+        }
+    }
+    
+    RETURN_NEW_STR(result);
+}
+
+PHP_METHOD(LPCM, upmix)
+{
+    char *pcm_data;
+    size_t pcm_len;
+    
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STRING(pcm_data, pcm_len)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    lpcm_object *obj = LPCM_OBJ(getThis());
+    
+    // O objeto descreve o stream de saída
+    if (obj->channels != 2) {
+        zend_throw_exception(NULL, "upmix requires channels=2", 0);
+        RETURN_THROWS();
+    }
+    
+    int bytes_per_sample = obj->bit_depth / 8;
+    size_t frames = pcm_len / bytes_per_sample;
+    
+    if (frames == 0) {
+        RETURN_EMPTY_STRING();
+    }
+    
+    zend_string *result = lpcm_alloc_result(frames * bytes_per_sample * 2);
+    
+    // Duplicação é só rearranjo de bytes: endianness não importa
+    if (bytes_per_sample == 2) {
+        interleave2_s16((const int16_t *)pcm_data, (const int16_t *)pcm_data, (int16_t *)ZSTR_VAL(result), frames);
+    } else {
+        insert_channel_bytes(ZSTR_VAL(result), pcm_data, frames, 2, 0, bytes_per_sample);
+        insert_channel_bytes(ZSTR_VAL(result), pcm_data, frames, 2, 1, bytes_per_sample);
+    }
+    
+    RETURN_NEW_STR(result);
+}
+
+PHP_METHOD(LPCM, extractChannel)
+{
+    char *pcm_data;
+    size_t pcm_len;
+    zend_long channel, channels = 0;
+    zend_bool channels_is_null = 1;
     
     ZEND_PARSE_PARAMETERS_START(2, 3)
-        Z_PARAM_LONG(channels)
-        Z_PARAM_LONG(bit_depth)
+        Z_PARAM_STRING(pcm_data, pcm_len)
+        Z_PARAM_LONG(channel)
         Z_PARAM_OPTIONAL
-        Z_PARAM_BOOL(is_big_endian)
+        Z_PARAM_LONG_OR_NULL(channels, channels_is_null)
     ZEND_PARSE_PARAMETERS_END();
     
     lpcm_object *obj = LPCM_OBJ(getThis());
     
-    // Valida channels
-    if (channels != 1 && channels != 2) {
-        zend_throw_exception(NULL, "Channels must be 1 (mono) or 2 (stereo)", 0);
+    channels = lpcm_stream_channels(obj, "extractChannel", channels, channels_is_null);
+    if (channels == 0) {
+        RETURN_THROWS();
+    }
+    if (channel < 0 || channel >= channels) {
+        zend_throw_exception(NULL, "Channel index out of range", 0);
         RETURN_THROWS();
     }
     
-    // Valida bit_depth
-    if (bit_depth != 8 && bit_depth != 16 && bit_depth != 24 && bit_depth != 32) {
-        zend_throw_exception(NULL, "Bit depth must be 8, 16, 24, or 32", 0);
+    int bytes_per_sample = obj->bit_depth / 8;
+    size_t frames = pcm_len / (bytes_per_sample * channels);
+    
+    if (frames == 0) {
+        RETURN_EMPTY_STRING();
+    }
+    
+    zend_string *result = lpcm_alloc_result(frames * bytes_per_sample);
+    
+    if (bytes_per_sample == 2 && channels == 2) {
+        int16_t *out = (int16_t *)ZSTR_VAL(result);
+        deinterleave2_s16((const int16_t *)pcm_data, channel == 0 ? out : NULL, channel == 1 ? out : NULL, frames);
+    } else {
+        extract_channel_bytes(pcm_data, ZSTR_VAL(result), frames, (int)channels, (int)channel, bytes_per_sample);
+    }
+    
+    RETURN_NEW_STR(result);
+}
+
+PHP_METHOD(LPCM, insertChannel)
+{
+    char *pcm_data, *mono_data;
+    size_t pcm_len, mono_len;
+    zend_long channel, channels = 0;
+    zend_bool channels_is_null = 1;
+    
+    ZEND_PARSE_PARAMETERS_START(3, 4)
+        Z_PARAM_STRING(pcm_data, pcm_len)
+        Z_PARAM_STRING(mono_data, mono_len)
+        Z_PARAM_LONG(channel)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG_OR_NULL(channels, channels_is_null)
+    ZEND_PARSE_PARAMETERS_END();
+    
+    lpcm_object *obj = LPCM_OBJ(getThis());
+    
+    channels = lpcm_stream_channels(obj, "insertChannel", channels, channels_is_null);
+    if (channels == 0) {
+        RETURN_THROWS();
+    }
+    if (channel < 0 || channel >= channels) {
+        zend_throw_exception(NULL, "Channel index out of range", 0);
         RETURN_THROWS();
     }
     
-    obj->channels = (int)channels;
-    obj->bit_depth = (int)bit_depth;
-    obj->is_big_endian = is_big_endian ? 1 : 0;
+    int bytes_per_sample = obj->bit_depth / 8;
+    size_t frames = pcm_len / (bytes_per_sample * channels);
+    
+    if (mono_len / bytes_per_sample != frames) {
+        zend_throw_exception(NULL, "Channel data must have one sample per frame", 0);
+        RETURN_THROWS();
+    }
+    if (frames == 0) {
+        RETURN_EMPTY_STRING();
+    }
+    
+    size_t len = frames * bytes_per_sample * channels;
+    zend_string *result = lpcm_alloc_result(len);
+    memcpy(ZSTR_VAL(result), pcm_data, len);
+    
+    if (bytes_per_sample == 2 && channels == 2) {
+        insert2_s16((int16_t *)ZSTR_VAL(result), (const int16_t *)mono_data, (int)channel, frames);
+    } else {
+        insert_channel_bytes(ZSTR_VAL(result), mono_data, frames, (int)channels, (int)channel, bytes_per_sample);
+    }
+    
+    RETURN_NEW_STR(result);
 }
 
-PHP_METHOD(LPCM, encodeMono)
+PHP_METHOD(LPCM, interleave)
 {
-    zval *samples_array;
+    HashTable *channels_ht;
     
     ZEND_PARSE_PARAMETERS_START(1, 1)
-        Z_PARAM_ARRAY(samples_array)
+        Z_PARAM_ARRAY_HT(channels_ht)
     ZEND_PARSE_PARAMETERS_END();
     
     lpcm_object *obj = LPCM_OBJ(getThis());
+    int bytes_per_sample = obj->bit_depth / 8;
+    uint32_t channels = zend_hash_num_elements(channels_ht);
+    const char *planes[LPCM_MAX_CHANNELS];
+    size_t frames = 0;
+    uint32_t ch = 0;
+    zval *entry;
     
-    if (obj->channels != 1) {
-        zend_throw_exception(NULL, "encodeMono requires channels=1", 0);
+    if (channels != (uint32_t)obj->channels) {
+        zend_throw_exception_ex(NULL, 0, "interleave requires channels=%d", obj->channels);
         RETURN_THROWS();
     }
     
-    HashTable *ht = Z_ARRVAL_P(samples_array);
-    size_t num_samples = zend_hash_num_elements(ht);
+    ZEND_HASH_FOREACH_VAL(channels_ht, entry) {
+        if (Z_TYPE_P(entry) != IS_STRING) {
+            zend_throw_exception(NULL, "Each channel must be a PCM string", 0);
+            RETURN_THROWS();
+        }
+        size_t count = Z_STRLEN_P(entry) / bytes_per_sample;
+        if (ch > 0 && count != frames) {
+            zend_throw_exception(NULL, "All channels must have the same length", 0);
+            RETURN_THROWS();
+        }
+        frames = count;
+        planes[ch++] = Z_STRVAL_P(entry);
+    } ZEND_HASH_FOREACH_END();
     
-    if (num_samples == 0) {
+    if (frames == 0) {
         RETURN_EMPTY_STRING();
     }
     
-    smart_str out = {0};
-    int bytes_per_sample = obj->bit_depth / 8;
+    zend_string *result = lpcm_alloc_result(frames * bytes_per_sample * channels);
     
-    zval *entry;
-    ZEND_HASH_FOREACH_VAL(ht, entry) {
-        int32_t sample = (int32_t)zval_get_long(entry);
-        
-        // Clipping baseado no bit depth (usa int64_t para evitar overflow em 32-bit)
-        int64_t max_val = ((int64_t)1 << (obj->bit_depth - 1)) - 1;
-        int64_t min_val = -((int64_t)1 << (obj->bit_depth - 1));
-        if (sample > max_val) sample = (int32_t)max_val;
-        if (sample < min_val) sample = (int32_t)min_val;
-        
-        // Escreve bytes conforme endianness
-        unsigned char bytes[4];
-        for (int i = 0; i < bytes_per_sample; i++) {
-            if (obj->is_big_endian) {
-                bytes[i] = (sample >> ((bytes_per_sample - 1 - i) * 8)) & 0xFF;
-            } else {
-                bytes[i] = (sample >> (i * 8)) & 0xFF;
-            }
+    if (bytes_per_sample == 2 && channels == 2) {
+        interleave2_s16((const int16_t *)planes[0], (const int16_t *)planes[1], (int16_t *)ZSTR_VAL(result), frames);
+    } else {
+        for (ch = 0; ch < channels; ch++) {
+            insert_channel_bytes(ZSTR_VAL(result), planes[ch], frames, (int)channels, (int)ch, bytes_per_sample);
         }
-        smart_str_appendl(&out, (char *)bytes, bytes_per_sample);
-    } ZEND_HASH_FOREACH_END();
+    }
     
-    smart_str_0(&out);
-    RETURN_STR(out.s);
+    RETURN_NEW_STR(result);
 }
 
-PHP_METHOD(LPCM, decodeMono)
+PHP_METHOD(LPCM, deinterleave)
 {
     char *pcm_data;
     size_t pcm_len;
+    zend_long channels = 0;
+    zend_bool channels_is_null = 1;
     
-    ZEND_PARSE_PARAMETERS_START(1, 1)
+    ZEND_PARSE_PARAMETERS_START(1, 2)
         Z_PARAM_STRING(pcm_data, pcm_len)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG_OR_NULL(channels, channels_is_null)
     ZEND_PARSE_PARAMETERS_END();
     
     lpcm_object *obj = LPCM_OBJ(getThis());
     
-    if (obj->channels != 1) {
-        zend_throw_exception(NULL, "decodeMono requires channels=1", 0);
+    channels = lpcm_stream_channels(obj, "deinterleave", channels, channels_is_null);
+    if (channels == 0) {
         RETURN_THROWS();
     }
     
     int bytes_per_sample = obj->bit_depth / 8;
-    size_t num_samples = pcm_len / bytes_per_sample;
+    size_t frames = pcm_len / (bytes_per_sample * channels);
+    zend_string *planes[LPCM_MAX_CHANNELS];
     
-    array_init(return_value);
+    for (zend_long ch = 0; ch < channels; ch++) {
+        planes[ch] = lpcm_alloc_result(frames * bytes_per_sample);
+    }
     
-    for (size_t i = 0; i < num_samples; i++) {
-        unsigned char *bytes = (unsigned char *)&pcm_data[i * bytes_per_sample];
-        int32_t sample = 0;
-        
-        // Lê bytes conforme endianness
-        for (int j = 0; j < bytes_per_sample; j++) {
-            if (obj->is_big_endian) {
-                sample |= ((int32_t)bytes[j]) << ((bytes_per_sample - 1 - j) * 8);
-            } else {
-                sample |= ((int32_t)bytes[j]) << (j * 8);
-            }
-        }
-        
-        // Extensão de sinal para valores negativos (usa int64_t para evitar overflow em 32-bit)
-        if (sample & ((int64_t)1 << (obj->bit_depth - 1))) {
-            sample |= ~(((int64_t)1 << obj->bit_depth) - 1);
+    if (bytes_per_sample == 2 && channels == 2) {
+        deinterleave2_s16((const int16_t *)pcm_data, (int16_t *)ZSTR_VAL(planes[0]), (int16_t *)ZSTR_VAL(planes[1]), frames);
+    } else {
+        for (zend_long ch = 0; ch < channels; ch++) {
+            extract_channel_bytes(pcm_data, ZSTR_VAL(planes[ch]), frames, (int)channels, (int)ch, bytes_per_sample);
         }
-        
-        add_next_index_long(return_value, sample);
+    }
+    
+    array_init_size(return_value, (uint32_t)channels);
+    for (zend_long ch = 0; ch < channels; ch++) {
+        add_next_index_str(return_value, planes[ch]);
     }
 }
 
-PHP_METHOD(LPCM, encodeStereo)
+PHP_METHOD(Analyzer, __construct)
 {
-    zval *left_array, *right_array;
+    zend_long sample_rate = 8000, fft_size = 256, clip_threshold = ANALYZER_DEFAULT_CLIP;
+    HashTable *bands = NULL;
+    double edges[ANALYZER_MAX_EDGES] = {300.0, 3400.0};
+    int edge_count = 2;
     
-    ZEND_PARSE_PARAMETERS_START(2, 2)
-        Z_PARAM_ARRAY(left_array)
-        Z_PARAM_ARRAY(right_array)
+    ZEND_PARSE_PARAMETERS_START(0, 4)
+        Z_PARAM_OPTIONAL
+        Z_PARAM_LONG(sample_rate)
+        Z_PARAM_LONG(fft_size)
+        Z_PARAM_ARRAY_HT_OR_NULL(bands)
+        Z_PARAM_LONG(clip_threshold)
     ZEND_PARSE_PARAMETERS_END();
     
-    lpcm_object *obj = LPCM_OBJ(getThis());
-    
-    if (obj->channels != 2) {
-        zend_throw_exception(NULL, "encodeStereo requires channels=2", 0);
+    if (sample_rate <= 0) {
+        zend_throw_exception(NULL, "Sample rate must be positive", 0);
         RETURN_THROWS();
     }
     
-    HashTable *left_ht = Z_ARRVAL_P(left_array);
-    HashTable *right_ht = Z_ARRVAL_P(right_array);
-    size_t left_count = zend_hash_num_elements(left_ht);
-    size_t right_count = zend_hash_num_elements(right_ht);
-    
-    if (left_count != right_count) {
-        zend_throw_exception(NULL, "Left and right arrays must have same length", 0);
+    if (fft_size < 64 || fft_size > 8192 || (fft_size & (fft_size - 1)) != 0) {
+        zend_throw_exception(NULL, "FFT size must be a power of two between 64 and 8192", 0);
         RETURN_THROWS();
     }
     
-    if (left_count == 0) {
-        RETURN_EMPTY_STRING();
+    if (clip_threshold < 1 || clip_threshold > 32768) {
+        zend_throw_exception(NULL, "Clip threshold must be between 1 and 32768", 0);
+        RETURN_THROWS();
     }
     
-    smart_str out = {0};
-    int bytes_per_sample = obj->bit_depth / 8;
-    
-    zval *left_entry, *right_entry;
-    HashPosition left_pos, right_pos;
-    
-    zend_hash_internal_pointer_reset_ex(left_ht, &left_pos);
-    zend_hash_internal_pointer_reset_ex(right_ht, &right_pos);
-    
-    for (size_t i = 0; i < left_count; i++) {
-        left_entry = zend_hash_get_current_data_ex(left_ht, &left_pos);
-        right_entry = zend_hash_get_current_data_ex(right_ht, &right_pos);
-        
-        int32_t samples[2] = {
-            (int32_t)zval_get_long(left_entry),
-            (int32_t)zval_get_long(right_entry)
-        };
+    if (bands) {
+        zval *entry;
         
-        for (int ch = 0; ch < 2; ch++) {
-            int32_t sample = samples[ch];
-            
-            // Clipping (usa int64_t para evitar overflow em 32-bit)
-            int64_t max_val = ((int64_t)1 << (obj->bit_depth - 1)) - 1;
-            int64_t min_val = -((int64_t)1 << (obj->bit_depth - 1));
-            if (sample > max_val) sample = (int32_t)max_val;
-            if (sample < min_val) sample = (int32_t)min_val;
-            
-            // Escreve bytes
-            unsigned char bytes[4];
-            for (int j = 0; j < bytes_per_sample; j++) {
-                if (obj->is_big_endian) {
-                    bytes[j] = (sample >> ((bytes_per_sample - 1 - j) * 8)) & 0xFF;
-                } else {
-                    bytes[j] = (sample >> (j * 8)) & 0xFF;
-                }
-            }
-            smart_str_appendl(&out, (char *)bytes, bytes_per_sample);
+        if (zend_hash_num_elements(bands) > ANALYZER_MAX_EDGES) {
+            zend_throw_exception(NULL, "At most 16 band edges are supported", 0);
+            RETURN_THROWS();
         }
         
-        zend_hash_move_forward_ex(left_ht, &left_pos);
-        zend_hash_move_forward_ex(right_ht, &right_pos);
+        edge_count = 0;
+        ZEND_HASH_FOREACH_VAL(bands, entry) {
+            double edge = zval_get_double(entry);
+            if (edge <= 0.0 || edge >= sample_rate / 2.0 || (edge_count > 0 && edge <= edges[edge_count - 1])) {
+                zend_throw_exception(NULL, "Band edges must be increasing and between 0 and the Nyquist frequency", 0);
+                RETURN_THROWS();
+            }
+            edges[edge_count++] = edge;
+        } ZEND_HASH_FOREACH_END();
     }
     
-    smart_str_0(&out);
-    RETURN_STR(out.s);
+    analyzer_configure(ANALYZER_OBJ(getThis()), (int)sample_rate, (int)fft_size, edges, edge_count, (int)clip_threshold);
 }
 
-PHP_METHOD(LPCM, decodeStereo)
+PHP_METHOD(Analyzer, update)
 {
-    char *pcm_data;
-    size_t pcm_len;
+    zend_string *pcm;
     
     ZEND_PARSE_PARAMETERS_START(1, 1)
-        Z_PARAM_STRING(pcm_data, pcm_len)
+        Z_PARAM_STR(pcm)
     ZEND_PARSE_PARAMETERS_END();
     
-    lpcm_object *obj = LPCM_OBJ(getThis());
+    analyzer_update(ANALYZER_OBJ(getThis()), (const int16_t *)ZSTR_VAL(pcm), ZSTR_LEN(pcm) / 2);
     
-    if (obj->channels != 2) {
-        zend_throw_exception(NULL, "decodeStereo requires channels=2", 0);
-        RETURN_THROWS();
-    }
+    RETURN_TRUE;
+}
+
+PHP_METHOD(Analyzer, analyze)
+{
+    zend_string *pcm;
     
-    int bytes_per_sample = obj->bit_depth / 8;
-    size_t num_frames = pcm_len / (bytes_per_sample * 2);
+    ZEND_PARSE_PARAMETERS_START(1, 1)
+        Z_PARAM_STR(pcm)
+    ZEND_PARSE_PARAMETERS_END();
     
-    zval left_array, right_array;
-    array_init(&left_array);
-    array_init(&right_array);
+    analyzer_object *an = ANALYZER_OBJ(getThis());
     
-    for (size_t i = 0; i < num_frames; i++) {
-        for (int ch = 0; ch < 2; ch++) {
-            unsigned char *bytes = (unsigned char *)&pcm_data[(i * 2 + ch) * bytes_per_sample];
-            int32_t sample = 0;
-            
-            // Lê bytes
-            for (int j = 0; j < bytes_per_sample; j++) {
-                if (obj->is_big_endian) {
-                    sample |= ((int32_t)bytes[j]) << ((bytes_per_sample - 1 - j) * 8);
-                } else {
-                    sample |= ((int32_t)bytes[j]) << (j * 8);
-                }
-            }
-            
-            // Extensão de sinal (usa int64_t para evitar overflow em 32-bit)
-            if (sample & ((int64_t)1 << (obj->bit_depth - 1))) {
-                sample |= ~(((int64_t)1 << obj->bit_depth) - 1);
-            }
-            
-            if (ch == 0) {
-                add_next_index_long(&left_array, sample);
-            } else {
-                add_next_index_long(&right_array, sample);
-            }
-        }
+    analyzer_reset(an);
+    analyzer_update(an, (const int16_t *)ZSTR_VAL(pcm), ZSTR_LEN(pcm) / 2);
+    
+    // Último quadro parcial entra completado com zeros
+    if (an->fill > 0) {
+        memset(an->work + an->fill, 0, (an->fft_size - an->fill) * sizeof(double));
+        analyzer_spectrum(an);
+        an->fill = 0;
     }
     
-    array_init(return_value);
-    add_next_index_zval(return_value, &left_array);
-    add_next_index_zval(return_value, &right_array);
+    analyzer_stats(an, return_value);
+}
+
+PHP_METHOD(Analyzer, getStats)
+{
+    analyzer_stats(ANALYZER_OBJ(getThis()), return_value);
+}
+
+PHP_METHOD(Analyzer, reset)
+{
+    analyzer_reset(ANALYZER_OBJ(getThis()));
+    
+    RETURN_TRUE;
 }
 
 ZEND_BEGIN_ARG_INFO_EX(arginfo_void, 0, 0, 0)
@@ -714,6 +3431,7 @@ ZEND_END_ARG_INFO()
 ZEND_BEGIN_ARG_INFO_EX(arginfo_construct, 0, 0, 0)
     ZEND_ARG_TYPE_INFO(0, srcRate, IS_LONG, 1)
     ZEND_ARG_TYPE_INFO(0, dstRate, IS_LONG, 1)
+    ZEND_ARG_TYPE_INFO(0, quality, IS_LONG, 0)
 ZEND_END_ARG_INFO()
 
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_sample, 0, 1, IS_STRING, 0)
@@ -726,15 +3444,61 @@ ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_process, 0, 1, IS_STRING, 0)
     ZEND_ARG_TYPE_INFO(0, pcm, IS_STRING, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_flush, 0, 0, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
 ZEND_BEGIN_ARG_WITH_RETURN_TYPE_MASK_EX(arginfo_returnEmpty, 0, 0, MAY_BE_STRING|MAY_BE_FALSE)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_setFrameSize, 0, 1, _IS_BOOL, 0)
+    ZEND_ARG_TYPE_INFO(0, frameSize, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_push, 0, 1, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, pcm, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, srcRate, IS_LONG, 1)
+    ZEND_ARG_TYPE_INFO(0, dstRate, IS_LONG, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_MASK_EX(arginfo_pull, 0, 0, MAY_BE_STRING|MAY_BE_FALSE)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_pullInto, 0, 1, _IS_BOOL, 0)
+    ZEND_ARG_INFO(1, frame)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_fanout, 0, 3, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, pcm, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, srcRate, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, dstRates, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_setAnalyzer, 0, 1, _IS_BOOL, 0)
+    ZEND_ARG_OBJ_INFO(0, analyzer, Analyzer, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_setSilenceThreshold, 0, 1, _IS_BOOL, 0)
+    ZEND_ARG_TYPE_INFO(0, threshold, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_getSilentSamples, 0, 0, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry psampler_methods[] = {
     PHP_ME(Resampler, __construct, arginfo_construct, ZEND_ACC_PUBLIC)
     PHP_ME(Resampler, reset, arginfo_void, ZEND_ACC_PUBLIC)
     PHP_ME(Resampler, sample, arginfo_sample, ZEND_ACC_PUBLIC)
     PHP_ME(Resampler, process, arginfo_process, ZEND_ACC_PUBLIC)
+    PHP_ME(Resampler, flush, arginfo_flush, ZEND_ACC_PUBLIC)
     PHP_ME(Resampler, returnEmpty, arginfo_returnEmpty, ZEND_ACC_PUBLIC)
+    PHP_ME(Resampler, setFrameSize, arginfo_setFrameSize, ZEND_ACC_PUBLIC)
+    PHP_ME(Resampler, push, arginfo_push, ZEND_ACC_PUBLIC)
+    PHP_ME(Resampler, pull, arginfo_pull, ZEND_ACC_PUBLIC)
+    PHP_ME(Resampler, pullInto, arginfo_pullInto, ZEND_ACC_PUBLIC)
+    PHP_ME(Resampler, fanout, arginfo_fanout, ZEND_ACC_PUBLIC)
+    PHP_ME(Resampler, setAnalyzer, arginfo_setAnalyzer, ZEND_ACC_PUBLIC)
+    PHP_ME(Resampler, setSilenceThreshold, arginfo_setSilenceThreshold, ZEND_ACC_PUBLIC)
+    PHP_ME(Resampler, getSilentSamples, arginfo_getSilentSamples, ZEND_ACC_PUBLIC)
     PHP_FE_END
 };
 
@@ -762,12 +3526,80 @@ ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_lpcm_decodeStereo, 0, 1, IS_ARRA
     ZEND_ARG_TYPE_INFO(0, pcmData, IS_STRING, 0)
 ZEND_END_ARG_INFO()
 
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_lpcm_downmix, 0, 1, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, pcmData, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, leftWeight, IS_DOUBLE, 0)
+    ZEND_ARG_TYPE_INFO(0, rightWeight, IS_DOUBLE, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_lpcm_upmix, 0, 1, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, pcmData, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_lpcm_extractChannel, 0, 2, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, pcmData, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, channel, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, channels, IS_LONG, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_lpcm_insertChannel, 0, 3, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, pcmData, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, channelData, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, channel, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, channels, IS_LONG, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_lpcm_interleave, 0, 1, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, channels, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_lpcm_deinterleave, 0, 1, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, pcmData, IS_STRING, 0)
+    ZEND_ARG_TYPE_INFO(0, channels, IS_LONG, 1)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_INFO_EX(arginfo_analyzer_construct, 0, 0, 0)
+    ZEND_ARG_TYPE_INFO(0, sampleRate, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, fftSize, IS_LONG, 0)
+    ZEND_ARG_TYPE_INFO(0, bands, IS_ARRAY, 1)
+    ZEND_ARG_TYPE_INFO(0, clipThreshold, IS_LONG, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_analyzer_update, 0, 1, _IS_BOOL, 0)
+    ZEND_ARG_TYPE_INFO(0, pcm, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_analyzer_analyze, 0, 1, IS_ARRAY, 0)
+    ZEND_ARG_TYPE_INFO(0, pcm, IS_STRING, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_analyzer_getStats, 0, 0, IS_ARRAY, 0)
+ZEND_END_ARG_INFO()
+
+ZEND_BEGIN_ARG_WITH_RETURN_TYPE_INFO_EX(arginfo_analyzer_reset, 0, 0, _IS_BOOL, 0)
+ZEND_END_ARG_INFO()
+
 static const zend_function_entry lpcm_methods[] = {
     PHP_ME(LPCM, __construct, arginfo_lpcm_construct, ZEND_ACC_PUBLIC)
     PHP_ME(LPCM, encodeMono, arginfo_lpcm_encodeMono, ZEND_ACC_PUBLIC)
     PHP_ME(LPCM, decodeMono, arginfo_lpcm_decodeMono, ZEND_ACC_PUBLIC)
     PHP_ME(LPCM, encodeStereo, arginfo_lpcm_encodeStereo, ZEND_ACC_PUBLIC)
     PHP_ME(LPCM, decodeStereo, arginfo_lpcm_decodeStereo, ZEND_ACC_PUBLIC)
+    PHP_ME(LPCM, downmix, arginfo_lpcm_downmix, ZEND_ACC_PUBLIC)
+    PHP_ME(LPCM, upmix, arginfo_lpcm_upmix, ZEND_ACC_PUBLIC)
+    PHP_ME(LPCM, extractChannel, arginfo_lpcm_extractChannel, ZEND_ACC_PUBLIC)
+    PHP_ME(LPCM, insertChannel, arginfo_lpcm_insertChannel, ZEND_ACC_PUBLIC)
+    PHP_ME(LPCM, interleave, arginfo_lpcm_interleave, ZEND_ACC_PUBLIC)
+    PHP_ME(LPCM, deinterleave, arginfo_lpcm_deinterleave, ZEND_ACC_PUBLIC)
+    PHP_FE_END
+};
+
+static const zend_function_entry analyzer_methods[] = {
+    PHP_ME(Analyzer, __construct, arginfo_analyzer_construct, ZEND_ACC_PUBLIC)
+    PHP_ME(Analyzer, analyze, arginfo_analyzer_analyze, ZEND_ACC_PUBLIC)
+    PHP_ME(Analyzer, update, arginfo_analyzer_update, ZEND_ACC_PUBLIC)
+    PHP_ME(Analyzer, getStats, arginfo_analyzer_getStats, ZEND_ACC_PUBLIC)
+    PHP_ME(Analyzer, reset, arginfo_analyzer_reset, ZEND_ACC_PUBLIC)
     PHP_FE_END
 };
 
@@ -784,6 +3616,10 @@ PHP_MINIT_FUNCTION(psampler)
     psampler_ce = zend_register_internal_class(&ce);
     psampler_ce->create_object = psampler_create;
     
+    zend_declare_class_constant_long(psampler_ce, "QUALITY_DEFAULT", sizeof("QUALITY_DEFAULT") - 1, PSAMPLER_QUALITY_DEFAULT);
+    zend_declare_class_constant_long(psampler_ce, "QUALITY_HIGH", sizeof("QUALITY_HIGH") - 1, PSAMPLER_QUALITY_HIGH);
+    zend_declare_class_constant_long(psampler_ce, "QUALITY_OFFLINE", sizeof("QUALITY_OFFLINE") - 1, PSAMPLER_QUALITY_OFFLINE);
+    
     // Inicializa handlers personalizados para LPCM
     memcpy(&lpcm_handlers, &std_object_handlers, sizeof(zend_object_handlers));
     lpcm_handlers.free_obj = lpcm_free;
@@ -793,22 +3629,60 @@ PHP_MINIT_FUNCTION(psampler)
     lpcm_ce = zend_register_internal_class(&ce);
     lpcm_ce->create_object = lpcm_create;
     
+    // Inicializa handlers personalizados para Analyzer
+    memcpy(&analyzer_handlers, &std_object_handlers, sizeof(zend_object_handlers));
+    analyzer_handlers.free_obj = analyzer_free;
+    analyzer_handlers.offset = XtOffsetOf(analyzer_object, std);
+    
+    INIT_CLASS_ENTRY(ce, "Analyzer", analyzer_methods);
+    analyzer_ce = zend_register_internal_class(&ce);
+    analyzer_ce->create_object = analyzer_create;
+    
+    generate_integer_filters();
+    
+    return SUCCESS;
+}
+
+PHP_RINIT_FUNCTION(psampler)
+{
+#if defined(ZTS) && defined(COMPILE_DL_PSAMPLER)
+    ZEND_TSRMLS_CACHE_UPDATE();
+#endif
+    
+    // Os bancos vivem na memória da requisição, que já foi liberada ao fim da anterior
+    PSAMPLER_G(banks) = NULL;
+    
     return SUCCESS;
 }
 
+static PHP_GINIT_FUNCTION(psampler)
+{
+#if defined(COMPILE_DL_PSAMPLER) && defined(ZTS)
+    ZEND_TSRMLS_CACHE_UPDATE();
+#endif
+    psampler_globals->banks = NULL;
+}
+
 zend_module_entry psampler_module_entry = {
     STANDARD_MODULE_HEADER,
     "psampler",
     NULL,
     PHP_MINIT(psampler),
     NULL,
-    NULL,
+    PHP_RINIT(psampler),
     NULL,
     NULL,
     PHP_PSAMPLER_VERSION,
-    STANDARD_MODULE_PROPERTIES
+    PHP_MODULE_GLOBALS(psampler),
+    PHP_GINIT(psampler),
+    NULL,
+    NULL,
+    STANDARD_MODULE_PROPERTIES_EX
 };
 
 #ifdef COMPILE_DL_PSAMPLER
+# ifdef ZTS
+ZEND_TSRMLS_CACHE_DEFINE()
+# endif
 ZEND_GET_MODULE(psampler)
 #endif
@@ -0,0 +1,112 @@
+<?php
+
+// Carrega a extensão
+if (!extension_loaded('psampler')) {
+    dl('./modules/psampler.so');
+}
+
+echo "=== Teste da Classe Analyzer ===\n\n";
+
+$rate = 8000;
+
+// Tom de 1 kHz com DC, alguns picos saturados e ruído leve
+$samples = [];
+for ($i = 0; $i < $rate * 2; $i++) {
+    $value = (int)round(100 + 9000 * sin(2 * M_PI * 1000 * $i / $rate)) + mt_rand(-50, 50);
+    if ($i % 1000 === 0) {
+        $value = 32767;
+    }
+    $samples[] = max(-32768, min(32767, $value));
+}
+$pcm = pack('s*', ...$samples);
+
+// Referência em PHP, como no test_audio_analysis.php
+$start = microtime(true);
+$sum = 0; $sumSq = 0; $peak = 0; $clipped = 0; $crossings = 0;
+foreach ($samples as $i => $s) {
+    $sum += $s;
+    $sumSq += $s * $s;
+    $peak = max($peak, abs($s));
+    if (abs($s) >= 32000) $clipped++;
+    if ($i > 0 && (($s < 0) !== ($samples[$i - 1] < 0))) $crossings++;
+}
+$userland = microtime(true) - $start;
+$n = count($samples);
+
+$analyzer = new Analyzer($rate, 256, [300, 3400]);
+$start = microtime(true);
+$m = $analyzer->analyze($pcm);
+$native = microtime(true) - $start;
+
+$checks = [
+    'samples' => $m['samples'] === $n,
+    'rms'     => abs($m['rms'] - sqrt($sumSq / $n)) < 1e-6,
+    'peak'    => $m['peak'] === $peak,
+    'dc'      => abs($m['dc'] - $sum / $n) < 1e-9,
+    'zcr'     => abs($m['zcr'] - $crossings / ($n - 1)) < 1e-12,
+    'clipped' => $m['clipped'] === $clipped,
+];
+foreach ($checks as $name => $ok) {
+    printf("%-8s %s\n", $name, $ok ? "✓ PASSOU" : "✗ FALHOU");
+}
+
+printf("\nBandas: <300 Hz %.4f | 300-3400 Hz %.4f | >3400 Hz %.4f\n", ...$m['bands']);
+echo "Energia concentrada na banda do tom: " . ($m['bands'][1] > 0.95 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+printf("PHP: %.4f s | Analyzer: %.4f s\n", $userland, $native);
+
+// update() em pacotes deve bater com analyze() no bloco inteiro
+$analyzer->reset();
+foreach (str_split($pcm, 320) as $packet) {
+    $analyzer->update($packet);
+}
+$acc = $analyzer->getStats();
+$same = $acc['samples'] === $m['samples'] && $acc['peak'] === $m['peak']
+    && $acc['clipped'] === $m['clipped'] && abs($acc['zcr'] - $m['zcr']) < 1e-12;
+echo "\nupdate() em pacotes == analyze(): " . ($same ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// Pacotes sem amostra completa (vazio ou 1 byte) depois de amostras negativas não contam cruzamento
+$edge = new Analyzer($rate);
+$edge->update(pack('s*', -100, -200));
+$edge->update('');
+$edge->update("\x01");
+$before = $edge->getStats();
+$edge->update(pack('s*', 100));
+$after = $edge->getStats();
+$ok = $before['samples'] === 2 && $before['zcr'] == 0.0 && $after['samples'] === 3 && abs($after['zcr'] - 0.5) < 1e-12;
+echo "update() vazio ou ímpar após negativas: " . ($ok ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// Análise acoplada ao resampler
+$resampler = new Resampler(8000, 16000);
+$fused = new Analyzer(16000);
+$resampler->setAnalyzer($fused);
+$out = '';
+foreach (str_split($pcm, 320) as $packet) {
+    $out .= $resampler->sample($packet, 8000, 16000);
+}
+$separate = (new Analyzer(16000))->analyze($out);
+$stats = $fused->getStats();
+echo "Analyzer acoplado vê toda a saída: " . ($stats['samples'] === intdiv(strlen($out), 2) && $stats['peak'] === $separate['peak'] ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+$resampler->setAnalyzer(null);
+$resampler->sample(substr($pcm, 0, 320));
+echo "setAnalyzer(null) desconecta: " . ($fused->getStats()['samples'] === $stats['samples'] ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// Sem bandas, apenas as métricas no tempo
+$timeOnly = (new Analyzer($rate, 256, []))->analyze($pcm);
+echo "Sem bandas: " . ($timeOnly['bands'] === [] && $timeOnly['frames'] === 0 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+try {
+    new Analyzer(8000, 300);
+    echo "FFT inválida: ✗ FALHOU\n";
+} catch (Exception $e) {
+    echo "FFT inválida rejeitada: ✓ PASSOU\n";
+}
+
+try {
+    new Analyzer(8000, 256, [3400, 300]);
+    echo "Bandas inválidas: ✗ FALHOU\n";
+} catch (Exception $e) {
+    echo "Bandas inválidas rejeitadas: ✓ PASSOU\n";
+}
+
+echo "\n=== Teste Concluído ===\n";
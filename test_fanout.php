@@ -0,0 +1,145 @@
+<?php
+
+// Carrega a extensão
+if (!extension_loaded('psampler')) {
+    dl('./modules/psampler.so');
+}
+
+echo "=== Teste de Fan-out (uma entrada, várias taxas) ===\n\n";
+
+$src = 48000;
+$rates = [8000, 16000, 44100];
+$seconds = 3;
+
+// Tom de 1 kHz com offset DC, em pacotes de 20 ms
+$samples = [];
+for ($i = 0; $i < $src * $seconds; $i++) {
+    $samples[] = (int)round(500 + 12000 * sin(2 * M_PI * 1000 * $i / $src));
+}
+$packets = str_split(pack('s*', ...$samples), 2 * $src / 50);
+
+// Resíduo fora do tom de 1 kHz na segunda metade da saída
+function toneSnr(string $pcm, int $rate): float
+{
+    $out = array_values(unpack('s*', $pcm));
+    $skip = intdiv(count($out), 2);
+    $c = 0.0; $s = 0.0; $n = 0;
+    for ($i = $skip; $i < count($out); $i++) {
+        $c += $out[$i] * cos(2 * M_PI * 1000 * $i / $rate);
+        $s += $out[$i] * sin(2 * M_PI * 1000 * $i / $rate);
+        $n++;
+    }
+    $c *= 2 / $n;
+    $s *= 2 / $n;
+    $signal = 0.0; $noise = 0.0;
+    for ($i = $skip; $i < count($out); $i++) {
+        $fit = $c * cos(2 * M_PI * 1000 * $i / $rate) + $s * sin(2 * M_PI * 1000 * $i / $rate);
+        $signal += $fit * $fit;
+        $noise += ($out[$i] - $fit) ** 2;
+    }
+    return 10 * log10($signal / max($noise, 1e-9));
+}
+
+// Fan-out
+$resampler = new Resampler();
+$fan = array_fill_keys($rates, '');
+$start = microtime(true);
+foreach ($packets as $packet) {
+    foreach ($resampler->fanout($packet, $src, $rates) as $rate => $pcm) {
+        $fan[$rate] .= $pcm;
+    }
+}
+$fanTime = microtime(true) - $start;
+
+// Um Resampler por taxa
+$separate = [];
+$objects = [];
+foreach ($rates as $rate) {
+    $objects[$rate] = new Resampler($src, $rate);
+    $separate[$rate] = '';
+}
+$start = microtime(true);
+foreach ($packets as $packet) {
+    foreach ($rates as $rate) {
+        $separate[$rate] .= $objects[$rate]->sample($packet, $src, $rate);
+    }
+}
+$separateTime = microtime(true) - $start;
+
+foreach ($rates as $rate) {
+    $expected = $src * $seconds * $rate / $src;
+    $count = intdiv(strlen($fan[$rate]), 2);
+    $snr = toneSnr($fan[$rate], $rate);
+    printf("%5d Hz: %6d amostras (esperado ~%d), SNR %.1f dB (separado: %.1f dB)\n",
+        $rate, $count, $expected, $snr, toneSnr($separate[$rate], $rate));
+    echo "  Quantidade de amostras: " . (abs($count - $expected) < 64 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+    echo "  Qualidade: " . ($snr > 60 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+}
+
+printf("\nFan-out: %.3f s | Resamplers separados: %.3f s\n", $fanTime, $separateTime);
+
+// Mesma taxa por fanout() e por sample(): o DC sai na taxa de saída nos dois, então até o
+// transiente inicial do offset coincide (48k -> 16k usa a cascata em sample(), já alinhada)
+$single = new Resampler();
+$viaSample = new Resampler($src, 16000);
+$fanOut = '';
+$sampleOut = '';
+foreach (array_slice($packets, 0, 50) as $packet) {
+    $fanOut .= $single->fanout($packet, $src, [16000])[16000];
+    $sampleOut .= $viaSample->sample($packet, $src, 16000);
+}
+$a = array_values(unpack('s*', $sampleOut));
+$b = array_values(unpack('s*', $fanOut));
+$error = 0.0; $power = 0.0; $worst = 0;
+for ($i = 0; $i < min(count($a), count($b)); $i++) {
+    $error += ($a[$i] - $b[$i]) ** 2;
+    $power += $a[$i] ** 2;
+    $worst = max($worst, abs($a[$i] - $b[$i]));
+}
+$diff = 10 * log10(max($error, 1e-9) / $power);
+printf("\nfanout([16000]) x sample() em 48k -> 16k: diferença %.1f dB, máx. %d %s\n", $diff, $worst,
+    $diff < -60 && $worst < 64 ? "✓ PASSOU" : "✗ FALHOU");
+
+// O limiar de silêncio do objeto também vale para o fan-out
+$quiet = new Resampler();
+$quiet->setSilenceThreshold(32);
+$noise = [];
+for ($i = 0; $i < $src; $i++) {
+    $noise[] = mt_rand(-20, 20);
+}
+$out = $quiet->fanout(pack('s*', ...$noise), $src, [8000, 16000]);
+$total = intdiv(strlen($out[8000]) + strlen($out[16000]), 2);
+echo "Limiar de silêncio respeitado: " . ($quiet->getSilentSamples() > $total / 2 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// Trocar o conjunto de taxas reinicia o grupo
+$out = $resampler->fanout($packets[0], $src, [8000]);
+echo "\nNovo conjunto de taxas: " . (array_keys($out) === [8000] ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+try {
+    $resampler->fanout($packets[0], $src, [8000, 8000]);
+    echo "Taxas repetidas: ✗ FALHOU\n";
+} catch (Exception $e) {
+    echo "Taxas repetidas rejeitadas: ✓ PASSOU\n";
+}
+
+try {
+    $resampler->fanout($packets[0], $src, []);
+    echo "Lista vazia: ✗ FALHOU\n";
+} catch (Exception $e) {
+    echo "Lista vazia rejeitada: ✓ PASSOU\n";
+}
+
+// Analyzer acoplado e preset longo não se aplicam ao fan-out: avisam em vez de ignorar
+$warnings = [];
+set_error_handler(function (int $errno, string $message) use (&$warnings) {
+    $warnings[] = $message;
+    return true;
+});
+$analyzed = new Resampler($src, 16000);
+$analyzed->setAnalyzer(new Analyzer(16000));
+$analyzed->fanout($packets[0], $src, [16000]);
+(new Resampler($src, 16000, Resampler::QUALITY_HIGH))->fanout($packets[0], $src, [16000]);
+restore_error_handler();
+echo "Avisos de Analyzer e preset: " . (count($warnings) === 2 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+echo "\n=== Teste Concluído ===\n";
@@ -0,0 +1,147 @@
+<?php
+
+// Carrega a extensão
+if (!extension_loaded('psampler')) {
+    dl('./modules/psampler.so');
+}
+
+echo "=== Teste do Modo Framed (FIFO de Saída) ===\n\n";
+
+$src = 8000;
+$dst = 16000;
+$frameSize = 320;
+
+$samples = [];
+for ($i = 0; $i < $src * 2; $i++) {
+    $samples[] = (int)round(8000 * sin(2 * M_PI * 440 * $i / $src));
+}
+$input = pack('s*', ...$samples);
+
+// Pacotes de tamanho irregular, como chegam da rede
+$packets = [];
+for ($pos = 0, $k = 0; $pos < strlen($input); $k++) {
+    $len = 2 * (37 + ($k * 53) % 250);
+    $packets[] = substr($input, $pos, $len);
+    $pos += $len;
+}
+
+// Referência: sample() concatenado em PHP
+$reference = new Resampler($src, $dst);
+$expected = '';
+foreach ($packets as $packet) {
+    $expected .= $reference->sample($packet, $src, $dst);
+}
+
+$resampler = new Resampler($src, $dst);
+$resampler->setFrameSize($frameSize);
+
+$frames = [];
+$sizesOk = true;
+foreach ($packets as $packet) {
+    $ready = $resampler->push($packet, $src, $dst);
+    while (($frame = $resampler->pull()) !== false) {
+        $sizesOk = $sizesOk && strlen($frame) === $frameSize * 2;
+        $frames[] = $frame;
+        $ready--;
+    }
+    $sizesOk = $sizesOk && $ready === 0;
+}
+
+$joined = implode('', $frames);
+printf("%d pacotes -> %d quadros de %d amostras\n", count($packets), count($frames), $frameSize);
+echo "Quadros de tamanho fixo: " . ($sizesOk ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+echo "Conteúdo idêntico a sample(): " . ($joined === substr($expected, 0, strlen($joined)) ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+echo "Resto na FIFO menor que um quadro: " . (strlen($expected) - strlen($joined) < $frameSize * 2 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// Quadros retidos pelo chamador não podem ser sobrescritos
+$resampler->push(str_repeat(pack('s', 1000), 400));
+$first = $resampler->pull();
+$snapshot = bin2hex($first);
+$resampler->push(str_repeat(pack('s', -1000), 400));
+$resampler->pull();
+echo "Quadro retido preservado: " . (bin2hex($first) === $snapshot ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// pullInto() entrega os mesmos quadros que pull(), reescrevendo a mesma string quando ela não foi guardada
+$byCopy = new Resampler($src, $dst);
+$byCopy->setFrameSize($frameSize);
+$inPlace = new Resampler($src, $dst);
+$inPlace->setFrameSize($frameSize);
+$frame = null;
+$same = true;
+$kept = [];
+foreach ($packets as $k => $packet) {
+    $byCopy->push($packet, $src, $dst);
+    $inPlace->push($packet, $src, $dst);
+    while (($copy = $byCopy->pull()) !== false) {
+        $same = $same && $inPlace->pullInto($frame) && $frame === $copy;
+        if ($k % 7 === 0) {
+            $kept[] = [$frame, $copy];
+        }
+    }
+}
+echo "pullInto() igual a pull(): " . ($same && $inPlace->pullInto($frame) === false ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// Quadros guardados pelo chamador não são reescritos pelo pullInto() seguinte
+$intact = count($kept) > 0;
+foreach ($kept as [$saved, $copy]) {
+    $intact = $intact && $saved === $copy;
+}
+echo "pullInto() preserva quadros guardados: " . ($intact ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// returnEmpty() acompanha a FIFO
+$resampler->reset();
+echo "FIFO vazia após reset(): " . ($resampler->pull() === false && $resampler->returnEmpty() === '' ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+$resampler->push(substr($input, 0, 2000), $src, $dst);
+echo "returnEmpty() com quadro pronto: " . ($resampler->returnEmpty() === false ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// Desempenho: push/pull contra concatenação em PHP
+$iterations = 20;
+$start = microtime(true);
+for ($n = 0; $n < $iterations; $n++) {
+    $r = new Resampler($src, $dst);
+    $buffer = '';
+    foreach ($packets as $packet) {
+        $buffer .= $r->sample($packet, $src, $dst);
+        while (strlen($buffer) >= $frameSize * 2) {
+            $frame = substr($buffer, 0, $frameSize * 2);
+            $buffer = substr($buffer, $frameSize * 2);
+        }
+    }
+}
+$userland = microtime(true) - $start;
+
+$start = microtime(true);
+for ($n = 0; $n < $iterations; $n++) {
+    $r = new Resampler($src, $dst);
+    $r->setFrameSize($frameSize);
+    foreach ($packets as $packet) {
+        $r->push($packet, $src, $dst);
+        while (($frame = $r->pull()) !== false) {
+        }
+    }
+}
+$native = microtime(true) - $start;
+
+$start = microtime(true);
+for ($n = 0; $n < $iterations; $n++) {
+    $r = new Resampler($src, $dst);
+    $r->setFrameSize($frameSize);
+    $frame = '';
+    foreach ($packets as $packet) {
+        $r->push($packet, $src, $dst);
+        while ($r->pullInto($frame)) {
+        }
+    }
+}
+$reused = microtime(true) - $start;
+
+printf("\nRe-bufferização em PHP: %.3f s\nFIFO nativa (pull):     %.3f s\nFIFO nativa (pullInto): %.3f s\n", $userland, $native, $reused);
+
+try {
+    (new Resampler($src, $dst))->push($input);
+    echo "push() sem setFrameSize(): ✗ FALHOU\n";
+} catch (Exception $e) {
+    echo "push() sem setFrameSize() rejeitado: ✓ PASSOU\n";
+}
+
+echo "\n=== Teste Concluído ===\n";
@@ -0,0 +1,86 @@
+<?php
+
+// Carrega a extensão
+if (!extension_loaded('psampler')) {
+    dl('./modules/psampler.so');
+}
+
+echo "=== Teste de Razões Inteiras (Cascata Half-Band) ===\n\n";
+
+// Ajusta uma senoide de frequência conhecida e retorna o SNR em dB
+function sineSnr(array $samples, float $freq, int $rate, int $skip): float
+{
+    $c = 0.0; $s = 0.0; $n = 0;
+    for ($i = $skip; $i < count($samples); $i++) {
+        $c += $samples[$i] * cos(2 * M_PI * $freq * $i / $rate);
+        $s += $samples[$i] * sin(2 * M_PI * $freq * $i / $rate);
+        $n++;
+    }
+    $c *= 2 / $n;
+    $s *= 2 / $n;
+
+    $signal = 0.0; $noise = 0.0;
+    for ($i = $skip; $i < count($samples); $i++) {
+        $fit = $c * cos(2 * M_PI * $freq * $i / $rate) + $s * sin(2 * M_PI * $freq * $i / $rate);
+        $signal += $fit * $fit;
+        $noise += ($samples[$i] - $fit) ** 2;
+    }
+    return 10 * log10($signal / max($noise, 1e-9));
+}
+
+// Fase de um tom ajustado em samples[from..to)
+function sinePhase(array $samples, float $freq, int $rate, int $from, int $to): float
+{
+    $c = 0.0; $s = 0.0;
+    for ($i = $from; $i < $to; $i++) {
+        $c += $samples[$i] * cos(2 * M_PI * $freq * $i / $rate);
+        $s += $samples[$i] * sin(2 * M_PI * $freq * $i / $rate);
+    }
+    return atan2($c, $s);
+}
+
+// [origem, destino, atraso de grupo da cascata descontado no início, em amostras de saída]
+$conversions = [[8000, 16000, 31], [16000, 8000, 15], [16000, 48000, 23], [48000, 16000, 7], [24000, 48000, 31], [8000, 48000, 116]];
+
+foreach ($conversions as [$src, $dst, $delay]) {
+    $resampler = new Resampler($src, $dst);
+    $chunk = intdiv($src, 50); // 20 ms
+    $output = '';
+
+    for ($frame = 0; $frame < 100; $frame++) {
+        $samples = [];
+        for ($i = 0; $i < $chunk; $i++) {
+            $n = $frame * $chunk + $i;
+            $samples[] = (int)round(10000 * sin(2 * M_PI * 1000 * $n / $src));
+        }
+        $output .= $resampler->sample(pack('s*', ...$samples), $src, $dst);
+    }
+
+    $out = array_values(unpack('s*', $output));
+    $expected = intdiv(100 * $chunk * $dst, $src) - $delay;
+    // Descarta 0,5 s: o transiente do filtro de DC domina o ruído no início
+    $snr = sineSnr($out, 1000, $dst, intdiv($dst, 2));
+
+    $status = (count($out) === $expected && $snr > 80) ? "✓ PASSOU" : "✗ FALHOU";
+    printf("%5d -> %5d Hz: %d amostras (esperado %d), SNR %.1f dB %s\n", $src, $dst, count($out), $expected, $snr, $status);
+}
+
+// A cascata sai no mesmo instante que o polyphase (fanout() usa sempre o polyphase)
+echo "\nAlinhamento com o polyphase:\n";
+foreach ([[16000, 48000], [48000, 24000]] as [$src, $dst]) {
+    $samples = [];
+    for ($n = 0; $n < $src; $n++) {
+        $samples[] = (int)round(10000 * sin(2 * M_PI * 1000 * $n / $src));
+    }
+    $pcm = pack('s*', ...$samples);
+
+    $cascade = array_values(unpack('s*', (new Resampler($src, $dst))->sample($pcm, $src, $dst)));
+    $polyphase = array_values(unpack('s*', (new Resampler($src, $dst))->fanout($pcm, $src, [$dst])[$dst]));
+    $to = min(count($cascade), count($polyphase));
+
+    // Diferença de fase convertida em amostras de saída (antes da compensação: ~23 em 16k -> 48k)
+    $lag = (sinePhase($cascade, 1000, $dst, intdiv($to, 4), $to) - sinePhase($polyphase, 1000, $dst, intdiv($to, 4), $to)) * $dst / (2 * M_PI * 1000);
+    printf("%5d -> %5d Hz: defasagem %.3f amostras %s\n", $src, $dst, $lag, abs($lag) < 0.1 ? "✓ PASSOU" : "✗ FALHOU");
+}
+
+echo "\n=== Testes Concluídos ===\n";
@@ -88,4 +88,152 @@ echo "Right decodificado: " . implode(", ", $decoded_32[1]) . "\n";
 $match_32 = ($left_32 === $decoded_32[0] && $right_32 === $decoded_32[1]) ? "✓ PASSOU" : "✗ FALHOU";
 echo "Round-trip test: $match_32\n\n";
 
+// Teste 6: Operações de layout de canais (stereo 16-bit)
+echo "Teste 6: Downmix / Upmix / Extract / Insert (16-bit)\n";
+$lpcm_16 = new LPCM(2, 16, false);
+$left_6 = [100, -200, 32767, -32768, 50];
+$right_6 = [300, 200, 32767, -32768, -50];
+$stereo_6 = $lpcm_16->encodeStereo($left_6, $right_6);
+
+$mono_6 = unpack('s*', $lpcm_16->downmix($stereo_6));
+echo "Downmix (0.5/0.5): " . implode(", ", $mono_6) . "\n";
+$match_6a = (array_values($mono_6) === [200, 0, 32767, -32768, 0]) ? "✓ PASSOU" : "✗ FALHOU";
+echo "Downmix test: $match_6a\n";
+
+$loud_6 = unpack('s*', $lpcm_16->downmix($stereo_6, 1.0, 1.0));
+$match_6b = (array_values($loud_6)[2] === 32767 && array_values($loud_6)[3] === -32768) ? "✓ PASSOU" : "✗ FALHOU";
+echo "Downmix com saturação: $match_6b\n";
+
+$left_only = $lpcm_16->extractChannel($stereo_6, 0);
+$right_only = $lpcm_16->extractChannel($stereo_6, 1);
+$match_6c = (array_values(unpack('s*', $left_only)) === $left_6 && array_values(unpack('s*', $right_only)) === $right_6) ? "✓ PASSOU" : "✗ FALHOU";
+echo "Extract test: $match_6c\n";
+
+$dual_mono = $lpcm_16->upmix($left_only);
+$match_6d = ($lpcm_16->decodeStereo($dual_mono) === [$left_6, $left_6]) ? "✓ PASSOU" : "✗ FALHOU";
+echo "Upmix test: $match_6d\n";
+
+$swapped = $lpcm_16->insertChannel($lpcm_16->insertChannel($stereo_6, $right_only, 0), $left_only, 1);
+$match_6e = ($lpcm_16->decodeStereo($swapped) === [$right_6, $left_6]) ? "✓ PASSOU" : "✗ FALHOU";
+echo "Insert test (troca L/R): $match_6e\n\n";
+
+// Teste 6b: os kernels SSE2 processam 8 quadros por vez; vetores com 17+ quadros e cauda
+// ímpar passam pelos dois caminhos. Chamadas de 1 quadro usam só o caminho escalar.
+echo "Teste 6b: SIMD vs escalar (17, 23 e 37 quadros)\n";
+mt_srand(28);
+$simd_ok = true;
+foreach ([17, 23, 37] as $frames) {
+    $left_b = [];
+    $right_b = [];
+    for ($i = 0; $i < $frames; $i++) {
+        $left_b[] = ($i % 5 === 0) ? 32767 : mt_rand(-32768, 32767);
+        $right_b[] = ($i % 7 === 0) ? -32768 : mt_rand(-32768, 32767);
+    }
+    $stereo_b = $lpcm_16->encodeStereo($left_b, $right_b);
+    $mono_b = $lpcm_16->extractChannel($stereo_b, 1);
+
+    // Pesos enormes estouram o int32 da conversão SIMD se não houver saturação em float
+    foreach ([[0.5, 0.5], [1.0, 1.0], [0.3, -0.7], [1e6, 1e6], [-1e6, 0.0]] as [$wl, $wr]) {
+        $scalar = '';
+        for ($i = 0; $i < $frames; $i++) {
+            $scalar .= $lpcm_16->downmix(substr($stereo_b, 4 * $i, 4), $wl, $wr);
+        }
+        if ($lpcm_16->downmix($stereo_b, $wl, $wr) !== $scalar) {
+            echo "  downmix($wl, $wr) com $frames quadros diverge\n";
+            $simd_ok = false;
+        }
+    }
+
+    $scalar_left = $scalar_up = $scalar_insert = '';
+    for ($i = 0; $i < $frames; $i++) {
+        $frame = substr($stereo_b, 4 * $i, 4);
+        $scalar_left .= $lpcm_16->extractChannel($frame, 0);
+        $scalar_up .= $lpcm_16->upmix(substr($mono_b, 2 * $i, 2));
+        $scalar_insert .= $lpcm_16->insertChannel($frame, substr($mono_b, 2 * $i, 2), 0);
+    }
+    $checks = [
+        'extractChannel' => $lpcm_16->extractChannel($stereo_b, 0) === $scalar_left,
+        'upmix' => $lpcm_16->upmix($mono_b) === $scalar_up,
+        'insertChannel' => $lpcm_16->insertChannel($stereo_b, $mono_b, 0) === $scalar_insert,
+        'deinterleave' => $lpcm_16->deinterleave($stereo_b, 2) === [$scalar_left, $mono_b],
+        'interleave' => $lpcm_16->interleave([$scalar_left, $mono_b]) === $stereo_b,
+    ];
+    foreach ($checks as $op => $ok) {
+        if (!$ok) {
+            echo "  $op com $frames quadros diverge\n";
+            $simd_ok = false;
+        }
+    }
+}
+echo "SIMD = escalar: " . ($simd_ok ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+$huge = array_values(unpack('s*', $lpcm_16->downmix($lpcm_16->encodeStereo(array_fill(0, 17, 30000), array_fill(0, 17, -30000)), 1e6, 0.0)));
+echo "Saturação positiva com pesos enormes: " . ($huge === array_fill(0, 17, 32767) ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// Um objeto mono não trata os dados como stereo em nenhuma operação de layout
+$lpcm_mono_6 = new LPCM(1, 16, false);
+$mono_calls = [
+    'downmix' => fn() => $lpcm_mono_6->downmix($stereo_6),
+    'upmix' => fn() => $lpcm_mono_6->upmix($left_only),
+    'extractChannel' => fn() => $lpcm_mono_6->extractChannel($stereo_6, 1, 2),
+    'insertChannel' => fn() => $lpcm_mono_6->insertChannel($stereo_6, $left_only, 1, 2),
+    'deinterleave' => fn() => $lpcm_mono_6->deinterleave($stereo_6, 2),
+    'interleave' => fn() => $lpcm_mono_6->interleave([$left_only, $right_only]),
+];
+foreach ($mono_calls as $op => $call) {
+    try {
+        $call();
+        echo "$op em objeto mono: ✗ FALHOU\n";
+    } catch (Exception $e) {
+        echo "$op em objeto mono rejeitado: ✓ PASSOU\n";
+    }
+}
+// Sem o argumento channels vale o do objeto: no mono, extrair o canal 0 devolve o próprio stream
+$match_mono = ($lpcm_mono_6->extractChannel($left_only, 0) === $left_only
+    && $lpcm_mono_6->deinterleave($left_only) === [$left_only]) ? "✓ PASSOU" : "✗ FALHOU";
+echo "Canais padrão do objeto mono: $match_mono\n\n";
+
+// Teste 7: Interleave / Deinterleave com N canais (24-bit big-endian)
+echo "Teste 7: Interleave / Deinterleave 5.1 (24-bit Big-Endian)\n";
+$lpcm_24 = new LPCM(1, 24, true);
+$lpcm_51 = new LPCM(6, 24, true);
+$planes = [];
+for ($ch = 0; $ch < 6; $ch++) {
+    $planes[] = $lpcm_24->encodeMono([$ch * 1000, -$ch * 1000, 8388607 - $ch]);
+}
+$surround = $lpcm_51->interleave($planes);
+echo "Interleaved length: " . strlen($surround) . " bytes\n";
+$match_7a = ($lpcm_51->deinterleave($surround) === $planes) ? "✓ PASSOU" : "✗ FALHOU";
+echo "Round-trip test: $match_7a\n";
+$match_7b = ($lpcm_51->extractChannel($surround, 4) === $planes[4]) ? "✓ PASSOU" : "✗ FALHOU";
+echo "Extract canal 4: $match_7b\n";
+try {
+    $lpcm_51->deinterleave($surround, 2);
+    echo "Canais conflitantes: ✗ FALHOU\n\n";
+} catch (Exception $e) {
+    echo "Canais conflitantes rejeitados: ✓ PASSOU\n\n";
+}
+
+// Teste 8: Throughput comparado ao round-trip com arrays
+echo "Teste 8: Throughput Downmix vs decodeStereo/encodeMono\n";
+$big = $lpcm_16->encodeStereo(range(0, 47999), range(47999, 0, -1));
+$lpcm_mono16 = new LPCM(1, 16, false);
+
+$start = microtime(true);
+[$l, $r] = $lpcm_16->decodeStereo($big);
+$mixed = [];
+foreach ($l as $i => $v) {
+    $mixed[] = intdiv($v + $r[$i], 2);
+}
+$lpcm_mono16->encodeMono($mixed);
+$array_time = microtime(true) - $start;
+
+$start = microtime(true);
+for ($i = 0; $i < 100; $i++) {
+    $lpcm_16->downmix($big);
+}
+$native_time = (microtime(true) - $start) / 100;
+
+printf("Arrays: %.3f ms, nativo: %.3f ms (%.0fx)\n\n", $array_time * 1000, $native_time * 1000, $array_time / max($native_time, 1e-9));
+
 echo "=== Testes Concluídos ===\n";
@@ -0,0 +1,51 @@
+<?php
+
+// Carrega a extensão
+if (!extension_loaded('psampler')) {
+    dl('./modules/psampler.so');
+}
+
+echo "=== Teste de Memória por Sessão ===\n\n";
+
+$legs = 10000;
+$src = 48000;
+$dst = 44100;
+
+// Pacote de 20 ms
+$samples = [];
+for ($i = 0; $i < $src / 50; $i++) {
+    $samples[] = (int)round(8000 * sin(2 * M_PI * 1000 * $i / $src));
+}
+$packet = pack('s*', ...$samples);
+
+$before = memory_get_usage();
+$resamplers = [];
+for ($i = 0; $i < $legs; $i++) {
+    $r = new Resampler($src, $dst);
+    // Alguns pacotes para o buffer de entrada atingir o tamanho de regime
+    for ($k = 0; $k < 3; $k++) {
+        $r->sample($packet, $src, $dst);
+    }
+    $resamplers[] = $r;
+}
+$perSession = (memory_get_usage() - $before) / $legs;
+
+printf("%d sessões %d -> %d Hz: %.1f KB por sessão (%.1f MB no total)\n",
+    $legs, $src, $dst, $perSession / 1024, $perSession * $legs / 1048576);
+echo "Abaixo de 8 KB por sessão: " . ($perSession < 8192 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// A saída não depende de quantas sessões compartilham o banco
+$a = (new Resampler($src, $dst))->sample($packet, $src, $dst);
+$b = $resamplers[0];
+$b->reset();
+echo "Banco compartilhado não altera a saída: " . ($b->sample($packet, $src, $dst) === $a ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+// Blocos acima de 8192 amostras não são truncados
+$big = str_repeat($packet, 20);
+$out = (new Resampler($src, $dst))->sample($big, $src, $dst);
+$expected = intdiv(strlen($big), 2) * $dst / $src;
+printf("Bloco de %d amostras -> %d amostras (esperado ~%d)\n", intdiv(strlen($big), 2), intdiv(strlen($out), 2), $expected);
+echo "Bloco grande processado inteiro: " . (intdiv(strlen($out), 2) > $expected - 64 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+unset($resamplers);
+echo "\n=== Teste Concluído ===\n";
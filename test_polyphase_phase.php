@@ -0,0 +1,54 @@
+<?php
+
+// Carrega a extensão
+if (!extension_loaded('psampler')) {
+    dl('./modules/psampler.so');
+}
+
+echo "=== Teste de Fase do Polyphase Padrão (QUALITY_DEFAULT) ===\n\n";
+
+// Ajusta a senoide de frequência freq em out[from..to) e retorna [amplitude, fase, SNR em dB]
+function fitTone(array $out, float $freq, int $rate, int $from, int $to): array
+{
+    $c = 0.0; $s = 0.0; $n = $to - $from;
+    for ($i = $from; $i < $to; $i++) {
+        $c += $out[$i] * cos(2 * M_PI * $freq * $i / $rate);
+        $s += $out[$i] * sin(2 * M_PI * $freq * $i / $rate);
+    }
+    $c *= 2 / $n;
+    $s *= 2 / $n;
+    $residual = 0.0;
+    for ($i = $from; $i < $to; $i++) {
+        $residual += ($out[$i] - $c * cos(2 * M_PI * $freq * $i / $rate) - $s * sin(2 * M_PI * $freq * $i / $rate)) ** 2;
+    }
+    $amp = sqrt($c * $c + $s * $s);
+    return [$amp, atan2($c, $s), 10 * log10(($amp * $amp / 2) / max($residual / $n, 1e-9))];
+}
+
+// Razões não inteiras passam sempre pelo banco polyphase de 64 taps.
+// Antes da correção da direção da fase: -0.21 rad em 44.1k -> 16k, -1.18 rad em 8k -> 11.025k
+$conversions = [[44100, 16000], [16000, 44100], [8000, 11025], [48000, 44100], [22050, 8000], [44100, 48000]];
+
+foreach ($conversions as [$src, $dst]) {
+    $samples = [];
+    for ($n = 0; $n < $src; $n++) {
+        $samples[] = (int)round(10000 * sin(2 * M_PI * 1000 * $n / $src));
+    }
+    $pcm = pack('s*', ...$samples);
+
+    // Pacotes de 20 ms: sem o histórico entre blocos o SNR caía para 2-20 dB
+    $resampler = new Resampler($src, $dst);
+    $output = '';
+    foreach (str_split($pcm, 2 * intdiv($src, 50)) as $packet) {
+        $output .= $resampler->sample($packet, $src, $dst);
+    }
+
+    // A saída k corresponde ao instante k / dst da entrada: fase zero e amplitude preservada
+    $out = array_values(unpack('s*', $output));
+    [$amp, $phase, $snr] = fitTone($out, 1000, $dst, intdiv(count($out), 2), count($out));
+    $ok = abs($phase) < 0.01 && abs($amp - 10000) < 10 && $snr > 55;
+    printf("%5d -> %5d Hz: amplitude %.1f, fase %.4f rad, SNR %.1f dB %s\n",
+        $src, $dst, $amp, $phase, $snr, $ok ? "✓ PASSOU" : "✗ FALHOU");
+}
+
+echo "\n=== Teste Concluído ===\n";
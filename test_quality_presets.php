@@ -0,0 +1,164 @@
+<?php
+
+// Carrega a extensão
+if (!extension_loaded('psampler')) {
+    dl('./modules/psampler.so');
+}
+
+echo "=== Teste dos Presets de Qualidade (Filtro Longo) ===\n\n";
+
+$presets = [
+    'QUALITY_DEFAULT' => Resampler::QUALITY_DEFAULT,
+    'QUALITY_HIGH'    => Resampler::QUALITY_HIGH,
+    'QUALITY_OFFLINE' => Resampler::QUALITY_OFFLINE,
+];
+
+// Gera uma senoide (ou soma de senoides) em PCM 16-bit
+function tone(array $freqs, float $amplitude, int $rate, int $count): string
+{
+    $samples = [];
+    for ($i = 0; $i < $count; $i++) {
+        $v = 0.0;
+        foreach ($freqs as $f) {
+            $v += $amplitude * sin(2 * M_PI * $f * $i / $rate);
+        }
+        $samples[] = (int)round($v);
+    }
+    return pack('s*', ...$samples);
+}
+
+// Resampleia em blocos e fecha o fluxo com flush()
+function convert(int $src, int $dst, int $quality, string $input, int $chunkBytes = 8192): array
+{
+    $resampler = new Resampler($src, $dst, $quality);
+    $output = '';
+    foreach (str_split($input, $chunkBytes) as $chunk) {
+        $output .= $resampler->sample($chunk, $src, $dst);
+    }
+    $output .= $resampler->flush();
+    return array_values(unpack('s*', $output));
+}
+
+// Ajusta a senoide de frequência freq em out[from..to) e retorna [amplitude, fase, resíduo em dB]
+function fitTone(array $out, float $freq, int $rate, int $from, int $to, float $reference): array
+{
+    $c = 0.0; $s = 0.0; $n = $to - $from;
+    for ($i = $from; $i < $to; $i++) {
+        $c += $out[$i] * cos(2 * M_PI * $freq * $i / $rate);
+        $s += $out[$i] * sin(2 * M_PI * $freq * $i / $rate);
+    }
+    $c *= 2 / $n;
+    $s *= 2 / $n;
+    $residual = 0.0;
+    for ($i = $from; $i < $to; $i++) {
+        $fit = $c * cos(2 * M_PI * $freq * $i / $rate) + $s * sin(2 * M_PI * $freq * $i / $rate);
+        $residual += ($out[$i] - $fit) ** 2;
+    }
+    return [sqrt($c * $c + $s * $s), atan2($c, $s), 10 * log10(max($residual / $n, 1e-9) / ($reference * $reference / 2))];
+}
+
+// Energia do trecho central em dB relativos a uma senoide de amplitude reference
+function levelDb(array $out, float $reference): float
+{
+    $from = intdiv(count($out), 4);
+    $to = 3 * $from;
+    $energy = 0.0;
+    for ($i = $from; $i < $to; $i++) {
+        $energy += $out[$i] * $out[$i];
+    }
+    return 10 * log10(max($energy / ($to - $from), 1e-9) / ($reference * $reference / 2));
+}
+
+// Teste 1: tom de 1 kHz (banda passante) somado a 8.6 kHz (deve ser rejeitado em 16 kHz)
+echo "Teste 1: 48 kHz -> 16 kHz, 1 kHz + 8.6 kHz\n";
+$src = 48000;
+$dst = 16000;
+$seconds = 3;
+$input = tone([1000, 8600], 8000, $src, $src * $seconds);
+$rejection = [];
+
+foreach ($presets as $name => $quality) {
+    $start = microtime(true);
+    $out = convert($src, $dst, $quality, $input);
+    $elapsed = microtime(true) - $start;
+
+    // Energia residual fora do tom de 1 kHz, medida na segunda metade da saída
+    [, , $rejection[$name]] = fitTone($out, 1000, $dst, intdiv(count($out), 2), count($out), 8000);
+    printf("  %-16s %6d amostras, tom de 8.6 kHz em %.1f dB, %.3f s\n", $name, count($out), $rejection[$name], $elapsed);
+}
+$ok = $rejection['QUALITY_HIGH'] < -80 && $rejection['QUALITY_OFFLINE'] < -80
+    && $rejection['QUALITY_HIGH'] < $rejection['QUALITY_DEFAULT'] - 40;
+echo "  HIGH/OFFLINE abaixo de -80 dB e 40 dB melhores que DEFAULT: " . ($ok ? "✓ PASSOU" : "✗ FALHOU") . "\n\n";
+
+// Teste 2: SNR e alinhamento de um tom em 44.1 kHz -> 48 kHz (ramos polyphase, L/M = 160/147)
+echo "Teste 2: 44.1 kHz -> 48 kHz, tom de 1 kHz\n";
+$input = tone([1000], 20000, 44100, 44100 * 2);
+foreach (['QUALITY_HIGH', 'QUALITY_OFFLINE'] as $name) {
+    $out = convert(44100, 48000, $presets[$name], $input);
+    [$amp, $phase, $residual] = fitTone($out, 1000, 48000, 48000, count($out) - 4800, 20000);
+
+    // Atraso de grupo compensado: a fase da saída bate com a da entrada (1 amostra = 0.13 rad)
+    $ok = -$residual > 85 && abs($amp - 20000) < 20 && abs($phase) < 0.02;
+    printf("  %-16s SNR %.1f dB, amplitude %.1f, fase %.4f rad %s\n", $name, -$residual, $amp, $phase, $ok ? "✓ PASSOU" : "✗ FALHOU");
+}
+echo "\n";
+
+// Teste 3: rejeição fora da banda acima da obtida pelo preset padrão
+echo "Teste 3: rejeição na banda de corte\n";
+$cases = [
+    // [origem, destino, tom, limite HIGH, limite OFFLINE]
+    [48000, 44100, 22500, -85, -85],
+    [44100, 16000, 9000, -100, -100],
+    [44100, 48000, 21000, 0, -90],
+];
+foreach ($cases as [$from, $to, $freq, $highLimit, $offlineLimit]) {
+    $input = tone([$freq], 30000, $from, $from * 2);
+    $level = [];
+    foreach ($presets as $name => $quality) {
+        $level[$name] = levelDb(convert($from, $to, $quality, $input), 30000);
+    }
+
+    // Em 44.1k -> 48k, 21 kHz cai na transição do HIGH e na banda de corte do OFFLINE
+    $ok = $level['QUALITY_HIGH'] < $level['QUALITY_DEFAULT'] + 0.5
+        && $level['QUALITY_HIGH'] <= $highLimit
+        && $level['QUALITY_OFFLINE'] <= $offlineLimit
+        && $level['QUALITY_OFFLINE'] < $level['QUALITY_DEFAULT'] - 30;
+    printf("  %5d -> %5d Hz, tom de %5d Hz: DEFAULT %.1f dB, HIGH %.1f dB, OFFLINE %.1f dB %s\n",
+        $from, $to, $freq, $level['QUALITY_DEFAULT'], $level['QUALITY_HIGH'], $level['QUALITY_OFFLINE'], $ok ? "✓ PASSOU" : "✗ FALHOU");
+}
+echo "\n";
+
+// Teste 4: tamanho exato da saída depois do flush
+echo "Teste 4: sample() + flush() = ceil(entrada * dst / src)\n";
+$cases = [[48000, 16000, 1000], [16000, 48000, 700], [44100, 48000, 882], [48000, 44100, 960], [8000, 11025, 160], [96000, 48000, 4096]];
+foreach ($cases as [$from, $to, $chunk]) {
+    $count = (int)($from * 1.37) + 3;
+    $input = tone([440], 10000, $from, $count);
+    $expected = intdiv($count * $to + $from - 1, $from);
+    foreach (['QUALITY_HIGH', 'QUALITY_OFFLINE'] as $name) {
+        $out = convert($from, $to, $presets[$name], $input, 2 * $chunk);
+        $status = count($out) === $expected ? "✓ PASSOU" : "✗ FALHOU";
+        printf("  %5d -> %5d Hz %-16s %d amostras (esperado %d) %s\n", $from, $to, $name, count($out), $expected, $status);
+    }
+}
+echo "\n";
+
+// Teste 5: flush() reinicia o fluxo; no preset padrão não há cauda
+$input = tone([1000], 10000, 44100, 20000);
+$resampler = new Resampler(44100, 48000, Resampler::QUALITY_HIGH);
+$first = $resampler->sample($input, 44100, 48000) . $resampler->flush();
+$second = $resampler->sample($input, 44100, 48000) . $resampler->flush();
+echo "Fluxo repetido após flush() é idêntico: " . ($first === $second ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+$resampler = new Resampler(44100, 48000);
+$resampler->sample($input, 44100, 48000);
+echo "flush() no preset padrão retorna vazio: " . ($resampler->flush() === '' ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+try {
+    new Resampler(48000, 16000, 7);
+    echo "Preset inválido: ✗ FALHOU\n";
+} catch (Exception $e) {
+    echo "Preset inválido rejeitado: ✓ PASSOU\n";
+}
+
+echo "\n=== Testes Concluídos ===\n";
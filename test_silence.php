@@ -0,0 +1,90 @@
+<?php
+
+// Carrega a extensão
+if (!extension_loaded('psampler')) {
+    dl('./modules/psampler.so');
+}
+
+echo "=== Teste do Caminho Rápido de Silêncio ===\n\n";
+
+// Fala simulada: 60 ms de tom alternados com 60 ms de silêncio digital, em frames de 20 ms
+function buildFrames(int $rate, int $count): array
+{
+    $frameLen = intdiv($rate, 50);
+    $frames = [];
+    for ($f = 0; $f < $count; $f++) {
+        $samples = [];
+        for ($i = 0; $i < $frameLen; $i++) {
+            $samples[] = (intdiv($f, 3) % 2) ? 0 : (int)round(8000 * sin(2 * M_PI * 440 * ($f * $frameLen + $i) / $rate));
+        }
+        $frames[] = pack('s*', ...$samples);
+    }
+    return $frames;
+}
+
+// Cascata half-band (8k <-> 16k, 16k -> 48k) e polyphase genérico (44.1k -> 16k, 48k -> 8k)
+$conversions = [[8000, 16000], [16000, 8000], [44100, 16000], [16000, 48000], [48000, 8000]];
+
+foreach ($conversions as [$src, $dst]) {
+    $frames = buildFrames($src, 150);
+
+    // Limiar 0 deve ser idêntico à convolução completa (limiar -1 nunca pula a convolução)
+    $exact = new Resampler($src, $dst);
+    $reference = new Resampler($src, $dst);
+    $reference->setSilenceThreshold(-1);
+
+    $outExact = '';
+    $outRef = '';
+    $start = microtime(true);
+    foreach ($frames as $frame) {
+        $outExact .= $exact->sample($frame, $src, $dst);
+    }
+    $elapsed = microtime(true) - $start;
+    foreach ($frames as $frame) {
+        $outRef .= $reference->sample($frame, $src, $dst);
+    }
+
+    $total = intdiv(strlen($outExact), 2);
+    $silent = $exact->getSilentSamples();
+    printf("%5d -> %5d: %d amostras, %.0f%% pelo caminho rápido, %.3f s\n",
+        $src, $dst, $total, 100 * $silent / max($total, 1), $elapsed);
+    printf("  md5 com caminho rápido %s, sem %s\n", md5($outExact), md5($outRef));
+    echo "  Idêntica à convolução completa: " . (md5($outExact) === md5($outRef) && strlen($outRef) > 0 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+    echo "  Silêncio detectado: " . ($silent > 0 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+    echo "  Referência sem caminho rápido: " . ($reference->getSilentSamples() === 0 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+}
+
+// Ruído de conforto abaixo do limiar também deve usar o caminho rápido
+echo "\nRuído de conforto (±20) com limiar 32:\n";
+$noise = [];
+for ($i = 0; $i < 8000; $i++) {
+    $noise[] = mt_rand(-20, 20);
+}
+$resampler = new Resampler(8000, 16000);
+$resampler->setSilenceThreshold(32);
+$out = '';
+foreach (str_split(pack('s*', ...$noise), 320) as $frame) {
+    $out .= $resampler->sample($frame, 8000, 16000);
+}
+$total = intdiv(strlen($out), 2);
+printf("  %d de %d amostras pelo caminho rápido\n", $resampler->getSilentSamples(), $total);
+echo "  Resultado: " . ($resampler->getSilentSamples() > $total / 2 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+$resampler->reset();
+echo "  Contador zerado após reset(): " . ($resampler->getSilentSamples() === 0 ? "✓ PASSOU" : "✗ FALHOU") . "\n";
+
+try {
+    $resampler->setSilenceThreshold(-2);
+    echo "Limiar negativo inválido: ✗ FALHOU\n";
+} catch (Exception $e) {
+    echo "Limiar negativo inválido rejeitado: ✓ PASSOU\n";
+}
+
+try {
+    $resampler->setSilenceThreshold(40000);
+    echo "Limiar inválido: ✗ FALHOU\n";
+} catch (Exception $e) {
+    echo "Limiar inválido rejeitado: ✓ PASSOU\n";
+}
+
+echo "\n=== Teste Concluído ===\n";